@@ -29,6 +29,7 @@ namespace bloodcircuit {
 string BloodCircuit::vasculatureFile;
 string BloodCircuit::transitionsFile;
 string BloodCircuit::fingerprintFile;
+bool BloodCircuit::stationaryStart = false;
 
 BloodCircuit::BloodCircuit(shared_ptr<Printer> printer) {
     m_bloodvessels = map<int, shared_ptr<BloodVessel>>();
@@ -43,7 +44,7 @@ BloodCircuit::BloodCircuit(unsigned int numberOfCancerCells,
                            unsigned int numberOfCarTCells,
                            unsigned int numberOfTCells,
                            unsigned int injectionVessel,
-                           unsigned int detectionVessel,
+                           vector<int> detectionVessels,
                            unsigned int injectionTime,
                            shared_ptr<Printer> printer) {
     m_bloodvessels = map<int, shared_ptr<BloodVessel>>();
@@ -52,14 +53,18 @@ BloodCircuit::BloodCircuit(unsigned int numberOfCancerCells,
     ConnectBloodVessels();
     SetTransitionProbabilities();
     SetFingerprintTimes();
-    cout << "detection Vessel: " << detectionVessel << endl;
-    SetGatewayVessel(detectionVessel);
+    for (int detectionVessel : detectionVessels) {
+        cout << "detection Vessel: " << detectionVessel << endl;
+        SetGatewayVessel(detectionVessel);
+    }
 
     injectionVesselID = injectionVessel < m_bloodvessels.size()
                             ? injectionVessel
                             : m_bloodvessels.size() - 1;
     cout << "injection Vessel: " << injectionVesselID << endl;
-    if (m_bloodvessels.size() > 1)
+    if (m_bloodvessels.size() > 1 && stationaryStart)
+        DistributeStationary(numberOfCancerCells, numberOfTCells);
+    else if (m_bloodvessels.size() > 1)
         InjectParticles(0, 0, 0, numberOfCancerCells, numberOfTCells,
                        m_bloodvessels[injectionVessel], 0);
     AddCarTCellInjectionToVessel(numberOfCarTCells, injectionVessel,
@@ -117,7 +122,7 @@ shared_ptr<BloodCircuit> BloodCircuit::BeginSimulation(unsigned int simulationDu
 shared_ptr<BloodCircuit> BloodCircuit::CancerSimulation(unsigned int numCancerCells, 
         unsigned int numCarTCells, unsigned int numTCells,
         unsigned int simulationDuration, unsigned int injectionTime,
-        unsigned int injectionVessel, unsigned int detectionVessel,
+        unsigned int injectionVessel, vector<int> detectionVessels,
         bool isDeterministic, string simFile, string gwFile) {
     try {
         Randomizer::InitRandomizer(isDeterministic);
@@ -128,7 +133,7 @@ shared_ptr<BloodCircuit> BloodCircuit::CancerSimulation(unsigned int numCancerCe
         // setup bloodcircuit
         shared_ptr<BloodCircuit> circuit = make_shared<BloodCircuit>(
                                   numCancerCells, numCarTCells, numTCells, 
-                                  injectionVessel, detectionVessel, 
+                                  injectionVessel, detectionVessels,
                                   injectionTime, printNano);
 
         map<int, shared_ptr<BloodVessel>> circuitMap =
@@ -147,8 +152,75 @@ shared_ptr<BloodCircuit> BloodCircuit::CancerSimulation(unsigned int numCancerCe
     }
 }
 
-BloodCircuit::~BloodCircuit() { m_bloodvessels.clear(); 
-printer->~Printer();}
+BloodCircuit::~BloodCircuit() {
+    m_bloodvessels.clear();
+    // writes the remaining output, the Printer may outlive the circuit
+    printer->Close();
+}
+
+void BloodCircuit::FinishStep() { printer->FinishStep(); }
+
+OutputOffsets BloodCircuit::FlushOutput() { return printer->Flush(); }
+
+shared_ptr<Printer> BloodCircuit::GetPrinter() { return printer; }
+
+void BloodCircuit::SetPrinter(shared_ptr<Printer> value) {
+    printer->Close();
+    printer = value;
+    for (auto &vessel : m_bloodvessels)
+        vessel.second->SetPrinter(printer);
+}
+
+void BloodCircuit::SetCarTCellInjection(unsigned int numberOfCarTCells,
+                                        unsigned int injectionVessel,
+                                        unsigned int injectionTime) {
+    for (auto &vessel : m_bloodvessels)
+        vessel.second->AddCarTCellInjection(-1, -1, -1);
+    AddCarTCellInjectionToVessel(numberOfCarTCells, injectionVessel,
+                                 injectionTime);
+}
+
+map<int, CarTCell::CarTCellInjection> BloodCircuit::GetCarTCellInjections() {
+    map<int, CarTCell::CarTCellInjection> injections;
+    for (auto &vessel : m_bloodvessels)
+        injections[vessel.first] = vessel.second->GetCarTCellInjection();
+    return injections;
+}
+
+void BloodCircuit::SetCarTCellInjections(
+    const map<int, CarTCell::CarTCellInjection> &injections) {
+    for (auto &injection : injections)
+        m_bloodvessels[injection.first]->AddCarTCellInjection(
+            injection.second.m_injectionTime,
+            injection.second.m_injectionVessel,
+            injection.second.m_injectionNumber);
+}
+
+void BloodCircuit::SaveState(ostream &out) {
+    uint64_t count = m_bloodvessels.size();
+    WriteState(out, count);
+    // the map is in ascending ID order
+    for (auto &vessel : m_bloodvessels) {
+        WriteState(out, vessel.first);
+        vessel.second->SaveState(out);
+    }
+}
+
+void BloodCircuit::LoadState(istream &in) {
+    uint64_t count;
+    ReadState(in, count);
+    if (count != m_bloodvessels.size())
+        throw runtime_error("Checkpoint has " + to_string(count) +
+                            " vessels, the vasculature " +
+                            to_string(m_bloodvessels.size()));
+    for (auto &vessel : m_bloodvessels) {
+        int id;
+        ReadState(in, id);
+        if (id != vessel.first)
+            throw runtime_error("Checkpoint does not match the vasculature");
+        vessel.second->LoadState(in);
+    }
+}
 
 map<int, shared_ptr<BloodVessel>> BloodCircuit::GetBloodCircuit() {
     return m_bloodvessels;
@@ -179,7 +251,8 @@ void BloodCircuit::InjectParticles(
     cout << "Starting first injections" << endl;
     int nanobotGroupSize = 1;
     shared_ptr<RandomStream> distribute_randomly =
-        Randomizer::GetNewRandomStream(0, bloodvessel->GetNumberOfStreams());
+        Randomizer::GetNewRandomStream(0, bloodvessel->GetNumberOfStreams(),
+                                       bloodvessel->GetbloodvesselID(), 0);
     Position m_coordinateStart = bloodvessel->GetStartPositionBloodVessel();
     int intervall = (numberOfParticles >= nanobotGroupSize)
                         ? div(numberOfParticles, nanobotGroupSize).quot
@@ -234,6 +307,7 @@ void BloodCircuit::InjectParticles(
     // Distribute cancer cells uniformly
     if (numberOfCancerCells > 0) {
         cout << "---> Cancer cells" << endl;
+        ReservePooled<CancerCell>(numberOfCancerCells);
         int bloodcircuitSize = m_bloodvessels.size();
         for (int i = 1; i <= numberOfCancerCells; ++i) {
             unsigned int vesselID = (i % bloodcircuitSize) + 1;
@@ -243,6 +317,7 @@ void BloodCircuit::InjectParticles(
     // Distribute healthy T cells uniformly
     if (numberOfTCells > 0) {
         cout << "---> T cells" << endl;
+        ReservePooled<TCell>(numberOfTCells);
         int bloodcircuitSize = m_bloodvessels.size();
         for (int i = 1; i <= numberOfTCells; ++i) {
             unsigned int vesselID = (i % bloodcircuitSize) + 1;
@@ -263,11 +338,130 @@ void BloodCircuit::InjectParticles(
     }
     // Print Particles in csv-file.
     bloodvessel->PrintParticlesOfVessel();
+    // the placement gets a chunk of its own, the first step prints the same
+    // Particles again with the same step number
+    if (printer->RecordsStep(GlobalTimer::GetStep()))
+        printer->FinishStep();
+}
+
+map<int, vector<double>> BloodCircuit::ComputeStationaryOccupancy() {
+    vector<shared_ptr<BloodVessel>> vessels;
+    map<int, size_t> indices;
+    for (auto &entry : m_bloodvessels) {
+        indices[entry.first] = vessels.size();
+        vessels.push_back(entry.second);
+    }
+    // Power iteration of the lazy chain, it has the same stationary
+    // distribution and converges although the circuit is periodic.
+    vector<double> rates(vessels.size(), 1.0 / vessels.size());
+    for (int iteration = 0; iteration < 100000; iteration++) {
+        vector<double> next(vessels.size(), 0);
+        for (size_t v = 0; v < vessels.size(); v++) {
+            next[v] += rates[v] / 2;
+            for (auto &successor : vessels[v]->GetSuccessors()) {
+                auto index = indices.find(successor.first->GetbloodvesselID());
+                if (index != indices.end())
+                    next[index->second] += rates[v] / 2 * successor.second;
+            }
+        }
+        double total = 0;
+        for (double rate : next)
+            total += rate;
+        double change = 0;
+        for (size_t v = 0; v < vessels.size(); v++) {
+            next[v] = total > 0 ? next[v] / total : 0;
+            change += fabs(next[v] - rates[v]);
+        }
+        rates = next;
+        if (change < 1e-12)
+            break;
+    }
+
+    map<int, vector<double>> occupancy;
+    double total = 0;
+    for (size_t v = 0; v < vessels.size(); v++) {
+        int numberOfStreams = vessels[v]->GetNumberOfStreams();
+        vector<double> &shares = occupancy[vessels[v]->GetbloodvesselID()];
+        for (int i = 0; i < numberOfStreams; i++) {
+            shares.push_back(rates[v] * vessels[v]->MeanResidenceTime(i) /
+                             numberOfStreams);
+            total += shares.back();
+        }
+    }
+    for (auto &entry : occupancy)
+        for (double &share : entry.second)
+            share = total > 0 ? share / total : 0;
+    return occupancy;
+}
+
+vector<int> BloodCircuit::Apportion(const vector<double> &shares, int count) {
+    vector<int> counts(shares.size(), 0);
+    vector<pair<double, size_t>> remainders;
+    double total = 0;
+    for (double share : shares)
+        total += share;
+    int assigned = 0;
+    for (size_t i = 0; i < shares.size(); i++) {
+        double expected = total > 0 ? shares[i] / total * count : 0;
+        counts[i] = (int)floor(expected);
+        assigned += counts[i];
+        remainders.push_back({expected - counts[i], i});
+    }
+    // the largest remainders get the rest, the first one on ties
+    stable_sort(remainders.begin(), remainders.end(),
+                [](const pair<double, size_t> &a,
+                   const pair<double, size_t> &b) { return a.first > b.first; });
+    for (size_t i = 0; assigned < count && i < remainders.size();
+         i++, assigned++)
+        counts[remainders[i].second]++;
+    return counts;
+}
+
+void BloodCircuit::DistributeStationary(int numberOfCancerCells,
+                                        int numberOfTCells) {
+    cout << "Starting stationary distribution" << endl;
+    map<int, vector<double>> occupancy = ComputeStationaryOccupancy();
+    vector<int> vesselIDs;
+    vector<double> vesselShares;
+    for (auto &entry : occupancy) {
+        vesselIDs.push_back(entry.first);
+        vesselShares.push_back(0);
+        for (double share : entry.second)
+            vesselShares.back() += share;
+    }
+    for (int cellType = 0; cellType < 2; cellType++) {
+        int numberOfCells =
+            cellType == 0 ? numberOfCancerCells : numberOfTCells;
+        if (numberOfCells <= 0)
+            continue;
+        cout << (cellType == 0 ? "---> Cancer cells" : "---> T cells")
+             << endl;
+        if (cellType == 0)
+            ReservePooled<CancerCell>(numberOfCells);
+        else
+            ReservePooled<TCell>(numberOfCells);
+        // per vessel first, so small shares of many streams add up
+        vector<int> vesselCounts = Apportion(vesselShares, numberOfCells);
+        for (size_t v = 0; v < vesselIDs.size(); v++) {
+            vector<int> streamCounts =
+                Apportion(occupancy[vesselIDs[v]], vesselCounts[v]);
+            for (size_t i = 0; i < streamCounts.size(); i++) {
+                for (int k = 0; k < streamCounts[i]; k++) {
+                    // the middles of equal parts of the stream
+                    double fraction = (k + 0.5) / streamCounts[i];
+                    if (cellType == 0)
+                        AddCancerCell(vesselIDs[v], i, fraction);
+                    else
+                        AddTCell(vesselIDs[v], i, fraction);
+                }
+            }
+        }
+    }
 }
 
 void BloodCircuit::AddParticle(int streamID,
                               shared_ptr<BloodVessel> bloodvessel, Position location) {
-    shared_ptr<Particle> tempNB = make_shared<Particle>();
+    shared_ptr<Particle> tempNB = MakePooled<Particle>();
     tempNB->SetParticleID(GetNextParticleID());
     tempNB->SetShouldChange(false);
     tempNB->SetPosition(location);
@@ -277,7 +471,7 @@ void BloodCircuit::AddParticle(int streamID,
 void BloodCircuit::AddNanocollector(int streamID,
                                     shared_ptr<BloodVessel> bloodvessel,
                                     Position location, int counter) {
-    shared_ptr<Nanocollector> tempNB = make_shared<Nanocollector>();
+    shared_ptr<Nanocollector> tempNB = MakePooled<Nanocollector>();
     tempNB->SetParticleID(GetNextParticleID());
     tempNB->SetShouldChange(false);
     tempNB->SetPosition(location);
@@ -288,7 +482,7 @@ void BloodCircuit::AddNanocollector(int streamID,
 void BloodCircuit::AddNanolocator(int streamID,
                                   shared_ptr<BloodVessel> bloodvessel, Position location,
                                   int counter) {
-    shared_ptr<NanoLocator> tempNB = make_shared<NanoLocator>();
+    shared_ptr<NanoLocator> tempNB = MakePooled<NanoLocator>();
     tempNB->SetParticleID(GetNextParticleID());
     tempNB->SetShouldChange(false);
     tempNB->SetPosition(location);
@@ -301,7 +495,7 @@ void BloodCircuit::AddNanoparticle(unsigned int vesselID,
                                    double detectionRadius, int streamID) {
     shared_ptr<BloodVessel> vessel = m_bloodvessels[vesselID];
     Position coordinateVessel = vessel->GetStartPositionBloodVessel();
-    shared_ptr<Nanoparticle> tempNP = make_shared<Nanoparticle>();
+    shared_ptr<Nanoparticle> tempNP = MakePooled<Nanoparticle>();
     tempNP->SetParticleID(GetNextParticleID());
     tempNP->SetShouldChange(false);
     tempNP->SetPosition(
@@ -311,10 +505,13 @@ void BloodCircuit::AddNanoparticle(unsigned int vesselID,
     vessel->AddParticleToStream(streamID, tempNP);
 }
 
-void BloodCircuit::AddCancerCell(unsigned int vesselID, int streamID) {
+void BloodCircuit::AddCancerCell(unsigned int vesselID, int streamID,
+                                 double fraction) {
     shared_ptr<BloodVessel> vessel = m_bloodvessels[vesselID];
-    Position coordinateVessel = vessel->GetStartPositionBloodVessel();
-    shared_ptr<CancerCell> tempNP = make_shared<CancerCell>();
+    Position coordinateVessel = fraction > 0
+        ? vessel->PositionInStream(streamID, fraction)
+        : vessel->GetStartPositionBloodVessel();
+    shared_ptr<CancerCell> tempNP = MakePooled<CancerCell>();
     tempNP->SetParticleID(GetNextParticleID());
     tempNP->SetShouldChange(false);
     tempNP->SetPosition(
@@ -322,10 +519,13 @@ void BloodCircuit::AddCancerCell(unsigned int vesselID, int streamID) {
     vessel->AddParticleToStream(streamID, tempNP);
 }
 
-void BloodCircuit::AddTCell(unsigned int vesselID, int streamID) {
+void BloodCircuit::AddTCell(unsigned int vesselID, int streamID,
+                            double fraction) {
     shared_ptr<BloodVessel> vessel = m_bloodvessels[vesselID];
-    Position coordinateVessel = vessel->GetStartPositionBloodVessel();
-    shared_ptr<TCell> tempNP = make_shared<TCell>();
+    Position coordinateVessel = fraction > 0
+        ? vessel->PositionInStream(streamID, fraction)
+        : vessel->GetStartPositionBloodVessel();
+    shared_ptr<TCell> tempNP = MakePooled<TCell>();
     tempNP->SetParticleID(GetNextParticleID());
     tempNP->SetShouldChange(false);
     tempNP->SetPosition(
@@ -336,7 +536,7 @@ void BloodCircuit::AddTCell(unsigned int vesselID, int streamID) {
 void BloodCircuit::AddCarTCell(unsigned int vesselID, int streamID) {
     shared_ptr<BloodVessel> vessel = m_bloodvessels[vesselID];
     Position coordinateVessel = vessel->GetStartPositionBloodVessel();
-    shared_ptr<CarTCell> tempNP = make_shared<CarTCell>();
+    shared_ptr<CarTCell> tempNP = MakePooled<CarTCell>();
     tempNP->SetParticleID(GetNextParticleID());
     tempNP->SetShouldChange(false);
     tempNP->SetPosition(
@@ -367,9 +567,11 @@ void BloodCircuit::AddCarTCellInjectionToVessel(unsigned int numberOfCarTCells,
     } else if (injectionTime == 0) {
         shared_ptr<RandomStream> distribute_randomly =
             Randomizer::GetNewRandomStream(
-                0, m_bloodvessels[injectionVessel]->GetNumberOfStreams());
+                0, m_bloodvessels[injectionVessel]->GetNumberOfStreams(),
+                injectionVessel, 1);
+        ReservePooled<CarTCell>(numberOfCarTCells);
         for (unsigned int i = 1; i <= numberOfCarTCells; ++i) {
-            AddCancerCell(injectionVessel, floor(distribute_randomly->GetValue()));
+            AddCarTCell(injectionVessel, floor(distribute_randomly->GetValue()));
         }
     } else {
         m_bloodvessels[injectionVessel]->AddCarTCellInjection(
@@ -553,18 +755,35 @@ void BloodCircuit::SetFingerprintTimes() {
 }
 
 void BloodCircuit::SetGatewayVessel(int detectionVesselID) {
-    m_bloodvessels[detectionVesselID]->SetIsGatewayVessel(true);
+    auto vessel = m_bloodvessels.find(detectionVesselID);
+    if (vessel == m_bloodvessels.end())
+        throw runtime_error("Unknown detection vessel: " +
+                            to_string(detectionVesselID));
+    vessel->second->SetIsGatewayVessel(true);
+}
+
+vector<int> BloodCircuit::ParseVesselIDs(string ids) {
+    vector<int> vesselIDs;
+    stringstream list(ids);
+    string id;
+    while (getline(list, id, ','))
+        if (id != "")
+            vesselIDs.push_back(stoi(id));
+    return vesselIDs;
 }
 
 void BloodCircuit::PrintStatistics() {
     int cancerCells = 0;
     int carTCells = 0;
-    for (int i = 0; i < m_bloodvessels.size(); i++) {
-        cancerCells += m_bloodvessels[i]->CountCancerCells();
-        carTCells += m_bloodvessels[i]->CountCarTCells();
+    int activeCarTCells = 0;
+    // the vessel IDs start at 1
+    for (auto &vessel : m_bloodvessels) {
+        cancerCells += vessel.second->CountCancerCells();
+        carTCells += vessel.second->CountCarTCells();
+        activeCarTCells += vessel.second->CountActiveCarTCells();
     }
     cout << "Cancer Cells: " << cancerCells << ", CAR-T Cells: " << carTCells
-         << endl;
+         << " (active: " << activeCarTCells << ")" << endl;
 }
 
 unsigned int BloodCircuit::GetNextParticleID() {
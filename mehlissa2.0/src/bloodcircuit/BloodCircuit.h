@@ -32,6 +32,7 @@
 #include "../utils/RandomStream.h"
 #include "../utils/IDCounter.h"
 #include "../utils/Position.h"
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <random>
@@ -122,9 +123,30 @@ private:
     void AddNanoparticle(unsigned int vesselID, double delay, 
                          double detectionRadius, int streamID);
 
-    void AddCancerCell(unsigned int vesselID, int streamID);
+    /// \param fraction of the way along the stream, 0 for the vessel start.
+    void AddCancerCell(unsigned int vesselID, int streamID,
+                       double fraction = 0);
 
-    void AddTCell(unsigned int vesselID, int streamID);
+    /// \param fraction of the way along the stream, 0 for the vessel start.
+    void AddTCell(unsigned int vesselID, int streamID, double fraction = 0);
+
+    /**
+     * \returns the expected share of the circulating Particles in each
+     * stream, by vessel ID. The visit rates of the vessels are the
+     * stationary distribution of the transition probabilities, found by
+     * power iteration. In a vessel a Particle stays for the mean residence
+     * time of its stream, the streams are entered equally often.
+     */
+    map<int, vector<double>> ComputeStationaryOccupancy();
+
+    /// \returns count split in proportion to shares, by largest remainders.
+    static vector<int> Apportion(const vector<double> &shares, int count);
+
+    /**
+     * Places the cells in the stationary occupancy of the streams, spread
+     * evenly along each stream, instead of at the vessel starts.
+     */
+    void DistributeStationary(int numberOfCancerCells, int numberOfTCells);
 
     void AddCarTCell(unsigned int vesselID, int streamID);
 
@@ -144,6 +166,9 @@ public:
     static string vasculatureFile;
     static string transitionsFile;
     static string fingerprintFile;
+
+    // start in the steady state, see DistributeStationary()
+    static bool stationaryStart;
     
     /// The constructor setting up the BloodCircuit.
     BloodCircuit(unsigned int numberOfParticles, unsigned int numberOfCollectors,
@@ -152,7 +177,7 @@ public:
 
     BloodCircuit(unsigned int numberOfCancerCells,
                  unsigned int numberOfCarTCells, unsigned int numberOfTCells,
-                 unsigned int injectionVessel, unsigned int detectionVessel, 
+                 unsigned int injectionVessel, vector<int> detectionVessels,
                  unsigned int injectionTime, shared_ptr<Printer> printer);
     
     BloodCircuit(shared_ptr<Printer> printer);
@@ -170,11 +195,48 @@ public:
     CancerSimulation(unsigned int numCancerCells, unsigned int numCarTCells,
                      unsigned int numTCells, unsigned int simulationDuration,
                      unsigned int injectionTime, unsigned int injectionVessel,
-                     unsigned int detectionVessel, bool isDeterministic,
+                     vector<int> detectionVessels, bool isDeterministic,
                      string simFile, string gwFile);
     
     void PrintStatistics();
 
+    /**
+     * \param ids comma separated vessel IDs, e.g. "23,29".
+     * \returns the vessel IDs.
+     */
+    static vector<int> ParseVesselIDs(string ids);
+
+    /// Writes the output of the finished step.
+    void FinishStep();
+
+    /// Writes the output of the finished steps to the files.
+    /// \returns the sizes of the files.
+    OutputOffsets FlushOutput();
+
+    /// Writes the state of all vessels, see BloodVessel::SaveState().
+    void SaveState(ostream &out);
+
+    /// Restores the state written by SaveState() into the same vasculature.
+    void LoadState(istream &in);
+
+    shared_ptr<Printer> GetPrinter();
+
+    /// Lets all vessels print to printer, the previous Printer is closed.
+    void SetPrinter(shared_ptr<Printer> value);
+
+    /// Replaces the pending CarTCell injections by one of numberOfCarTCells
+    /// into injectionVessel at injectionTime, e.g. for a branch.
+    void SetCarTCellInjection(unsigned int numberOfCarTCells,
+                              unsigned int injectionVessel,
+                              unsigned int injectionTime);
+
+    /// \returns the pending CarTCell injections by vessel ID.
+    map<int, CarTCell::CarTCellInjection> GetCarTCellInjections();
+
+    /// Replaces the pending CarTCell injections of all vessels.
+    void SetCarTCellInjections(
+        const map<int, CarTCell::CarTCellInjection> &injections);
+
     static unsigned int GetNextParticleID();
     
     /// Return the BloodCircuit map.
@@ -22,10 +22,18 @@
 namespace bloodcircuit {
 
 
-BloodVessel::BloodVessel() {
+bool BloodVessel::batchInteractions = false;
+
+// smallest cell of the interaction grid, about the diameter of a cell
+const double MinInteractionCellSize = 0.001;
+
+BloodVessel::BloodVessel()
+    : m_interactionGrid(MinInteractionCellSize, true),
+      m_detectionGrid(MinInteractionCellSize, false) {
     m_deltaT = 1;
     m_stepsPerSec = 1 / m_deltaT;
     m_secStepCounter = 0;
+    m_streamChangeLoop = 1;
     initStreams();
     m_changeStreamSet = true;
     m_basevelocity = 0;
@@ -60,6 +68,26 @@ shared_ptr<BloodVessel> BloodVessel::Step(uint64_t timeInS) {
                               && timeInS == 600)
             this->ReleaseParticles();
 
+    this->CheckInjection(timeInS);
+
+    if (this->IsEmpty())
+        return nullptr;
+    else
+        return shared_from_this();
+}
+
+void BloodVessel::StepCoarse(uint64_t timeInS, int seconds) {
+    this->CheckFingerprintRelease();
+    this->CheckParticleInteractions();
+    this->AgeCells(seconds);
+    this->PerformCellInteractions(seconds);
+    if (ReportsGateway())
+        PrintGatewayCounts();
+    this->PerformCellMitosis();
+    this->CheckInjection(timeInS);
+}
+
+void BloodVessel::CheckInjection(uint64_t timeInS) {
     if (this->injection.m_injectionVessel > 0) {
         if (this->injection.m_injectionTime <= timeInS) {
             cout << "Injecting CAR-T cells now" << endl;
@@ -68,11 +96,6 @@ shared_ptr<BloodVessel> BloodVessel::Step(uint64_t timeInS) {
             this->injection.m_injectionVessel = -1;
         }
     }
-
-    if (this->IsEmpty())
-        return nullptr;
-    else
-        return shared_from_this();
 }
 
 Position BloodVessel::SetPosition(Position nbv, double distance, double angle,
@@ -114,229 +137,510 @@ Position BloodVessel::SetPosition(Position nbv, double distance, double angle,
 }
 
 void BloodVessel::TranslateParticles() {
-    // FIXME: WAS IST DAS HIER????? 
-    //       Warum kann global nur jeder zweite Particle springen?
-    static int loop = 1;
-    if (loop == 2)
-        loop = 0;
+    // Particles change streams every second step. The counter is kept per
+    // vessel, so vessels can be stepped concurrently.
+    if (m_streamChangeLoop == 2)
+        m_streamChangeLoop = 0;
     // Change streams only in organs
-    if (loop == 0 && m_changeStreamSet == true &&
+    if (m_streamChangeLoop == 0 && m_changeStreamSet == true &&
         this->GetBloodVesselType() == ORGAN)
             ChangeStream();
     // Translate their position every timestep
     TranslatePosition(m_deltaT);
-    loop++;
+    m_streamChangeLoop++;
+}
+
+bool BloodVessel::ReplayMovement(unsigned int particleID, int stream,
+                                 double delay, uint64_t step, double &arc,
+                                 Position &position) {
+    ParticleStore &store = m_bloodstreams[stream]->GetParticleStore();
+    bool reachedEnd = PredictMovement(particleID, stream, delay, step, arc);
+    position = store.PositionAt(arc);
+    return reachedEnd;
+}
+
+bool BloodVessel::PredictMovement(unsigned int particleID, int stream,
+                                  double delay, uint64_t step, double &arc) {
+    arc += CalcStepDistance(particleID, stream, delay, step, m_deltaT);
+    return m_bloodstreams[stream]->GetParticleStore().IsOutside(arc);
 }
 
-bool BloodVessel::moveParticle(shared_ptr<Particle> nb, int i, int randVelocityOffset,
-                              bool direction, double dt) {
+double BloodVessel::CalcStepDistance(unsigned int particleID, int i,
+                                     double delay, uint64_t step, double dt) {
+    KeyedRandom random(step, m_bloodvesselID, particleID,
+                       KeyedRandom::MovementPurpose);
+    return SampleStepDistance(i, delay, dt, random);
+}
+
+double BloodVessel::SampleStepDistance(int i, double delay, double dt,
+                                       KeyedRandom &random) {
+    int randVelocityOffset = random.GetValue(0, 11);
+    bool direction = random.GetBoolean();
     double distance = 0.0;
     double velocity = m_bloodstreams[i]->GetVelocity();
-    if (nb->GetDelay() >= 0)
-        velocity = velocity * (nb->GetDelay());
+    if (delay >= 0)
+        velocity = velocity * delay;
 
     if (direction)
         distance = (velocity - ((velocity / 100) * randVelocityOffset)) * dt;
     else
         distance = (velocity + ((velocity / 100) * randVelocityOffset)) * dt;
-    // Check vessel direction and move accordingly.
-    Position nbv =
-        SetPosition(nb->GetPosition(), distance, GetBloodVesselAngle(),
-                    GetBloodVesselType(), m_startPositionBloodVessel.z);
-    nb->SetPosition(nbv);
-    nb->SetTimeStep();
-    double nbx = nb->GetPosition().x - m_startPositionBloodVessel.x;
-    double nby = nb->GetPosition().y - m_startPositionBloodVessel.y;
-    double length = sqrt(nbx * nbx + nby * nby);
-    // check if position exceeds bloodvessel
-    return (length > m_bloodvesselLength || (nbv.z < -2 && m_angle == 0) ||
-            (nbv.z > 2 && m_angle == 0));
+    return distance;
 }
 
-void BloodVessel::TranslatePosition(double dt) {
-    list<shared_ptr<Particle>> print;
-    int numCarTCells = 0;
-    int numCancerCells = 0;
-    // perform interaction between CarTCells and Cancer Cells
+void BloodVessel::SetStreamAxes() {
+    // the unit movement, following the vessel direction like SetPosition()
+    Position direction = SetPosition(Position(0, 0, 0), 1, m_angle,
+                                     m_bloodvesselType,
+                                     m_startPositionBloodVessel.z);
+    double inf = numeric_limits<double>::infinity();
     for (int i = 0; i < m_numberOfStreams; i++) {
-        for (uint j = 0; j < m_bloodstreams[i]->CountParticles(); j++) {
-            shared_ptr<Particle> nb = m_bloodstreams[i]->GetParticle(j);
-            if (nb->particleType == CarTCellType) {
-                // cout << "Found CarTCell" << endl;
-                shared_ptr<Particle> nb = m_bloodstreams[i]->GetParticle(j);
-                if (!nb->IsAlive()) {
-                    m_bloodstreams[i]->RemoveParticle(nb);
-                    j =-1;
-                    continue;
+        Position offset = m_bloodstreams[i]->GetOffset();
+        Position origin(m_startPositionBloodVessel.x + offset.x,
+                        m_startPositionBloodVessel.y + offset.y,
+                        m_startPositionBloodVessel.z + offset.z);
+        double arcMin = -inf;
+        double arcMax = inf;
+        // A Particle is inside while its distance from the vessel start in
+        // the xy plane does not exceed the vessel length: solve
+        // |offset + arc * direction|^2 <= length^2 for the arc.
+        double a = direction.x * direction.x + direction.y * direction.y;
+        double b = offset.x * direction.x + offset.y * direction.y;
+        double c = offset.x * offset.x + offset.y * offset.y -
+                   m_bloodvesselLength * m_bloodvesselLength;
+        if (a > 0) {
+            double discriminant = b * b - a * c;
+            if (discriminant >= 0) {
+                arcMin = (-b - sqrt(discriminant)) / a;
+                arcMax = (-b + sqrt(discriminant)) / a;
+            } else {
+                arcMin = inf;
+                arcMax = -inf;
+            }
+        } else if (c > 0) {
+            arcMin = inf;
+            arcMax = -inf;
+        }
+        // Vessels with angle 0 end at the z-planes -2 and 2.
+        if (m_angle == 0) {
+            if (direction.z != 0) {
+                double first = (-2 - origin.z) / direction.z;
+                double second = (2 - origin.z) / direction.z;
+                arcMin = max(arcMin, min(first, second));
+                arcMax = min(arcMax, max(first, second));
+            } else if (origin.z < -2 || origin.z > 2) {
+                arcMin = inf;
+                arcMax = -inf;
+            }
+        }
+        m_bloodstreams[i]->GetParticleStore().SetAxis(origin, direction,
+                                                      arcMin, arcMax);
+    }
+}
+
+void BloodVessel::PerformCellInteractions(int seconds) {
+    m_interactionGrid.Clear();
+    m_interactionCells.clear();
+    // encountered cells per type, every CarTCell meets all cells of the vessel
+    map<ParticleType, size_t> typeCounts;
+    double maxRadius = 0;
+    bool hasCarTCells = false;
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        for (uint j = 0; j < store.Size(); j++) {
+            ParticleType type = store.GetType(j);
+            if (type != CancerCellType && type != TCellType &&
+                type != CarTCellType)
+                continue;
+            typeCounts[type]++;
+            if (type == CarTCellType)
+                hasCarTCells = true;
+            else
+                maxRadius = max(maxRadius, store.GetDetectionRadius(j));
+            m_interactionGrid.Insert(store.GetPosition(j));
+            m_interactionCells.push_back({i, j, type, false});
+        }
+    }
+    if (!hasCarTCells)
+        return;
+    m_interactionGrid.SetCellSize(max(maxRadius, MinInteractionCellSize));
+    m_interactionGrid.Build();
+
+    if (batchInteractions)
+        PerformBatchInteractions(typeCounts, maxRadius, seconds);
+    else
+        PerformPairwiseInteractions(typeCounts, maxRadius, seconds);
+
+    // the cells were collected by ascending index per stream, removing them
+    // in reverse keeps the indices of the remaining ones valid
+    vector<shared_ptr<Particle>> deaths;
+    for (auto cell = m_interactionCells.rbegin();
+         cell != m_interactionCells.rend(); cell++) {
+        if (cell->removed)
+            deaths.push_back(
+                m_bloodstreams[cell->stream]->RemoveParticle(cell->index));
+    }
+    if (printer->RecordsEvents())
+        printer->PrintEvents(deaths, DeathEvent, m_bloodvesselID);
+}
+
+void BloodVessel::PerformPairwiseInteractions(
+    const map<ParticleType, size_t> &typeCounts, double maxRadius,
+    int seconds) {
+    for (size_t c = 0; c < m_interactionCells.size(); c++) {
+        InteractionCell &cell = m_interactionCells[c];
+        if (cell.type != CarTCellType || cell.removed)
+            continue;
+        ParticleStore &store =
+            m_bloodstreams[cell.stream]->GetParticleStore();
+        CarTCell &ctc = store.As<CarTCell>(cell.index);
+        if (!ctc.IsAlive()) {
+            cell.removed = true;
+            continue;
+        }
+        uint64_t step = GlobalTimer::GetStep();
+        for (auto &typeCount : typeCounts) {
+            KeyedRandom random(step, m_bloodvesselID, ctc.GetParticleID(),
+                               KeyedRandom::MitosisPurpose, typeCount.first);
+            // every second counts as an encounter of its own
+            ctc.AddPossibleMitosis(typeCount.first,
+                                   typeCount.second * seconds,
+                                   random.GetValue());
+        }
+
+        Position position = m_interactionGrid.GetPoint(c);
+        m_interactionCandidates.clear();
+        m_interactionGrid.Query(position, maxRadius, m_interactionCandidates);
+        // keep the order of the streams
+        sort(m_interactionCandidates.begin(), m_interactionCandidates.end());
+        for (size_t t : m_interactionCandidates) {
+            InteractionCell &target = m_interactionCells[t];
+            // a CarTCell does not kill itself
+            if (t == c || target.removed)
+                continue;
+            ParticleStore &targetStore =
+                m_bloodstreams[target.stream]->GetParticleStore();
+            bool killed = false;
+            double distSquared = m_interactionGrid.SquaredDistance(
+                position, m_interactionGrid.GetPoint(t));
+            double radius = targetStore.GetDetectionRadius(target.index);
+            // every pair of cells draws its own value
+            KeyedRandom random(step, m_bloodvesselID, ctc.GetParticleID(),
+                               KeyedRandom::KillPurpose,
+                               targetStore.GetID(target.index));
+            switch (target.type) {
+            case CancerCellType: {
+                if (distSquared <= radius * radius &&
+                    ctc.KillCancerCell(random.GetValue(), seconds) == true) {
+                    targetStore.As<CancerCell>(target.index).GetsDetected();
+                    killed = true;
                 }
-                shared_ptr<CarTCell> ctc = dynamic_pointer_cast<CarTCell>(nb);
-                if (ctc == NULL)
-                    continue;
-                for (int k = 0; k < m_numberOfStreams; k++) {
-                    for (uint l = 0; l < m_bloodstreams[k]->CountParticles();
-                         l++) {
-                        shared_ptr<Particle> nb2 = m_bloodstreams[k]->GetParticle(l);
-                        ctc->AddPossibleMitosis(nb2->particleType);
-                        switch (nb2->particleType) {
-                        case CancerCellType: {
-                            // cout << "Found CancerCell" << endl;
-                            shared_ptr<CancerCell> cc = dynamic_pointer_cast<CancerCell>(nb2);
-                            if (cc == NULL)
-                                continue;
-                            double dist = CalcDistance(nb, nb2);
-                            if (dist <= nb2->GetDetectionRadius()) {
-                                if (ctc->KillCancerCell() == true) {
-                                    // cout << "Killing CancerCell" << endl;
-                                    cc->GetsDetected();
-                                    m_bloodstreams[k]->RemoveParticle(nb2);
-                                    l -= 1;
-                                }
-                            }
-                            break;
-                        }
-                        case TCellType: {
-                            // cout << "Found TCell" << endl;
-                            shared_ptr<TCell> tc = dynamic_pointer_cast<TCell>(nb2);
-                            if (tc == NULL)
-                                continue;
-                            double dist = CalcDistance(nb, nb2);
-                            if (dist <= tc->GetDetectionRadius()) {
-                                if (ctc->KillTCell() == true) {
-                                    // cout << "Killing TCell" << endl;
-                                    tc->GetsDetected();
-                                    m_bloodstreams[k]->RemoveParticle(nb2);
-                                    l -= 1;
-                                }
-                            }
-                            break;
-                        }
-                        case CarTCellType: {
-                            // cout << "Found other CarTCell" << endl;
-                            shared_ptr<CarTCell> ctc2 = dynamic_pointer_cast<CarTCell>(nb2);
-                            if (ctc2 == NULL)
-                                continue;
-                            double dist = CalcDistance(nb, nb2);
-                            if (dist <= 0) {
-                                if (ctc->KillCarTCell() == true) {
-                                    // cout << "Killing other CarTCell" << endl;
-                                    m_bloodstreams[k]->RemoveParticle(nb2);
-                                    l -= 1;
-                                }
-                            }
-                            break;
-                        }
-                        default:
-                            break;
-                        }
-                    }
+                break;
+            }
+            case TCellType: {
+                if (distSquared <= radius * radius &&
+                    ctc.KillTCell(random.GetValue(), seconds) == true) {
+                    targetStore.As<TCell>(target.index).GetsDetected();
+                    killed = true;
                 }
+                break;
+            }
+            case CarTCellType: {
+                if (distSquared <= 0 &&
+                    ctc.KillCarTCell(random.GetValue(), seconds) == true)
+                    killed = true;
+                break;
+            }
+            default:
+                break;
+            }
+            if (killed) {
+                // a CarTCell becomes active with its first kill
+                target.removed = true;
+                store.SetActive(cell.index);
             }
         }
     }
+}
+
+bool BloodVessel::IsInDetectionRange(size_t c, size_t t) {
+    InteractionCell &target = m_interactionCells[t];
+    double distSquared = m_interactionGrid.SquaredDistance(
+        m_interactionGrid.GetPoint(c), m_interactionGrid.GetPoint(t));
+    if (target.type == CarTCellType)
+        return distSquared <= 0;
+    double radius = m_bloodstreams[target.stream]
+                        ->GetParticleStore()
+                        .GetDetectionRadius(target.index);
+    return distSquared <= radius * radius;
+}
+
+void BloodVessel::PerformBatchInteractions(
+    const map<ParticleType, size_t> &typeCounts, double maxRadius,
+    int seconds) {
+    // CarTCells taking part and their encounters (CarTCell, target) within
+    // the detection radius of the target, by type of the target
+    vector<size_t> carTCells;
+    map<ParticleType, vector<pair<size_t, size_t>>> encounters;
+    for (size_t c = 0; c < m_interactionCells.size(); c++) {
+        InteractionCell &cell = m_interactionCells[c];
+        if (cell.type != CarTCellType || cell.removed)
+            continue;
+        CarTCell &ctc =
+            m_bloodstreams[cell.stream]->GetParticleStore().As<CarTCell>(
+                cell.index);
+        if (!ctc.IsAlive()) {
+            cell.removed = true;
+            continue;
+        }
+        carTCells.push_back(c);
+        m_interactionCandidates.clear();
+        m_interactionGrid.Query(m_interactionGrid.GetPoint(c), maxRadius,
+                                m_interactionCandidates);
+        for (size_t t : m_interactionCandidates) {
+            // a CarTCell does not kill itself
+            if (t == c || m_interactionCells[t].removed)
+                continue;
+            if (IsInDetectionRange(c, t))
+                encounters[m_interactionCells[t].type].push_back({c, t});
+        }
+    }
+    if (carTCells.empty())
+        return;
+    // all CarTCells share the same probabilities
+    InteractionCell &first = m_interactionCells[carTCells[0]];
+    CarTCell &reference =
+        m_bloodstreams[first.stream]->GetParticleStore().As<CarTCell>(
+            first.index);
+
+    // number of kills per target type, then which encounters they are
+    uint64_t step = GlobalTimer::GetStep();
+    for (auto &typeEncounters : encounters) {
+        vector<pair<size_t, size_t>> &pairs = typeEncounters.second;
+        KeyedRandom random(step, m_bloodvesselID, 0,
+                           KeyedRandom::BatchKillPurpose, typeEncounters.first);
+        uint64_t kills = random.GetBinomialValue(
+            pairs.size(),
+            reference.GetFratricideP(typeEncounters.first, seconds));
+        for (uint64_t k = 0; k < kills; k++) {
+            // partial Fisher-Yates shuffle, pairs[k] is the k-th kill
+            swap(pairs[k], pairs[k + random.GetIntegerValue(
+                                         0, pairs.size() - k - 1)]);
+            InteractionCell &attacker = m_interactionCells[pairs[k].first];
+            InteractionCell &target = m_interactionCells[pairs[k].second];
+            if (attacker.removed || target.removed)
+                continue;
+            ParticleStore &attackerStore =
+                m_bloodstreams[attacker.stream]->GetParticleStore();
+            attackerStore.As<CarTCell>(attacker.index)
+                .RegisterKill(target.type);
+            attackerStore.SetActive(attacker.index);
+            // CancerCells and TCells are Nanoparticles
+            if (target.type != CarTCellType)
+                m_bloodstreams[target.stream]
+                    ->GetParticleStore()
+                    .As<Nanoparticle>(target.index)
+                    .GetsDetected();
+            target.removed = true;
+        }
+    }
+
+    // every CarTCell meets all cells of the vessel, so all have the same
+    // probability to perform mitosis, every second counts as an encounter
+    double logNoMitosisP = 0;
+    for (auto &typeCount : typeCounts)
+        logNoMitosisP += typeCount.second * seconds *
+                         log1p(-reference.GetMitosisP(typeCount.first));
+    KeyedRandom random(step, m_bloodvesselID, 0,
+                       KeyedRandom::BatchMitosisPurpose);
+    uint64_t mitoses =
+        random.GetBinomialValue(carTCells.size(), -expm1(logNoMitosisP));
+    for (uint64_t m = 0; m < mitoses; m++) {
+        swap(carTCells[m], carTCells[m + random.GetIntegerValue(
+                                         0, carTCells.size() - m - 1)]);
+        InteractionCell &cell = m_interactionCells[carTCells[m]];
+        m_bloodstreams[cell.stream]
+            ->GetParticleStore()
+            .As<CarTCell>(cell.index)
+            .SetWillPerformMitosis();
+    }
+}
+
+void BloodVessel::TranslatePosition(double dt) {
+    vector<Particle *> print;
+    vector<shared_ptr<Particle>> deaths;
+    // perform interaction between CarTCells and Cancer Cells
+    PerformCellInteractions();
+    // the gateway reports the cells before they move on
+    int numCarTCells = CountActiveCarTCells();
+    int numCancerCells = CountCancerCells();
 
+    uint64_t step = GlobalTimer::GetStep();
+    bool recordStep = printer->RecordsStep(step);
     // for every stream of the vessel
     for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
         // for every nanobot of the stream
-        for (uint j = 0; j < m_bloodstreams[i]->CountParticles(); j++) {
-            shared_ptr<Particle> nb = m_bloodstreams[i]->GetParticle(j);
-            shared_ptr<CarTCell> ctc = dynamic_pointer_cast<CarTCell>(nb);
-            if (nb->particleType == CarTCellType) {
-                shared_ptr<CarTCell>ctc = dynamic_pointer_cast<CarTCell>(nb);
-                if (ctc != NULL && ctc->IsActive())
-                    numCarTCells++;
-            }
-            if (nb->particleType == CancerCellType)
-                numCancerCells++;
-            shared_ptr<CancerCell> cc = dynamic_pointer_cast<CancerCell>(nb);
-            if (cc != NULL && cc->MustBeDeleted()) {
-                m_bloodstreams[i]->RemoveParticle(nb);
-                j -= 1;
-                continue;
+        for (uint j = 0; j < store.Size(); j++) {
+            ParticleType type = store.GetType(j);
+            if (type == CancerCellType) {
+                if (store.As<CancerCell>(j).MustBeDeleted()) {
+                    deaths.push_back(m_bloodstreams[i]->RemoveParticle(j));
+                    j -= 1;
+                    continue;
+                }
             }
             // move only nanobots that have not already been translated by
             // another vessel
-            if (nb->GetTimeStepInSeconds() < GlobalTimer::NowInSeconds()) {
+            if (store.GetTimeStep(j) < GlobalTimer::NowInSeconds()) {
+                bool reachedEnd = store.Advance(
+                    j, CalcStepDistance(store.GetID(j), i, store.GetDelay(j),
+                                        step, dt));
+                store.SetTimeStep(j, GlobalTimer::NowInSeconds());
                 // has nanobot reached end after moving
-                if (moveParticle(nb, i, Randomizer::GetRandomValue(0,11),
-                                Randomizer::GetRandomBoolean(), dt)) {
-                    
-                    reachedEndMap[i].push_back(nb);
-                    m_bloodstreams[i]->RemoveParticle(nb);
-                } else {
-                    print.push_back(nb);
+                if (reachedEnd) {
+                    reachedEndMap[i].push_back(
+                        m_bloodstreams[i]->RemoveParticle(j));
+                    j -= 1;
+                } else if (recordStep &&
+                           printer->RecordsParticle(store.GetID(j), type)) {
+                    print.push_back(&store.At(j));
                 }
             }
         }
     }
-    printer->PrintParticles(print, this->GetbloodvesselID());
-    if (m_isGatewayVessel == true || m_bloodvesselID == 1)
-        printer->PrintGateway(m_bloodvesselID, numCancerCells, numCarTCells);
+    if (print.size() > 0)
+        printer->PrintParticles(print, this->GetbloodvesselID());
+    if (deaths.size() > 0 && printer->RecordsEvents())
+        printer->PrintEvents(deaths, DeathEvent, m_bloodvesselID);
+    if (ReportsGateway())
+        PrintGateway(numCancerCells, numCarTCells);
+}
+
+bool BloodVessel::ChangesStreams() {
+    return m_changeStreamSet && GetBloodVesselType() == ORGAN &&
+           m_numberOfStreams > 1;
+}
+
+bool BloodVessel::ReportsGateway() {
+    return m_isGatewayVessel == true || m_bloodvesselID == 1;
+}
+
+void BloodVessel::PrintGateway(int numCancerCells, int numCarTCells) {
+    printer->PrintGateway(m_bloodvesselID, numCancerCells, numCarTCells);
+}
+
+void BloodVessel::PrintGatewayCounts() {
+    PrintGateway(CountCancerCells(), CountActiveCarTCells());
 }
 
 void BloodVessel::ChangeStream() {
     if (m_numberOfStreams > 1) {
+        uint64_t step = GlobalTimer::GetStep();
         // set half of the nanobots randomly to change
         for (int i = 0; i < m_numberOfStreams; i++) {
-            for (uint j = 0; j < m_bloodstreams[i]->CountParticles(); j++) {
-                if (Randomizer::GetRandomBoolean())
-                    m_bloodstreams[i]->GetParticle(j)->SetShouldChange(true);
+            ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+            for (uint j = 0; j < store.Size(); j++) {
+                if (WillChangeStream(store.GetID(j), step))
+                    store.SetShouldChange(j, true);
             }
         }
         // after all nanobots that should change are flagged, do change
-        for (int i = 0; i < m_numberOfStreams; i++) {
-            int direction = Randomizer::GetRandomBoolean() == true ? -1 : 1;
-            if (i == 0) // Special Case 1: outer lane left -> go to middle
-                direction = 1;
-            else if (i + 1 >= m_numberOfStreams) // Special Case 2: outer lane 
-                                                 // right -> go to middle
-                direction = -1;
-            // Move randomly left or right
-            DoChangeStreamIfPossible(i, i + direction);
-        }
+        for (int i = 0; i < m_numberOfStreams; i++)
+            DoChangeStreamIfPossible(i, StreamChangeDestination(i, step));
     }
 }
 
+bool BloodVessel::WillChangeStream(unsigned int particleID, uint64_t step) {
+    KeyedRandom random(step, m_bloodvesselID, particleID,
+                       KeyedRandom::StreamChangePurpose);
+    return random.GetBoolean();
+}
+
+int BloodVessel::StreamChangeDestination(int stream, uint64_t step) {
+    // keyed by the stream instead of a particle
+    KeyedRandom random(step, m_bloodvesselID, stream,
+                       KeyedRandom::StreamDirectionPurpose);
+    return NeighbourStream(stream, random.GetBoolean());
+}
+
+int BloodVessel::NeighbourStream(int stream, bool left) {
+    int direction = left == true ? -1 : 1;
+    if (stream == 0) // Special Case 1: outer lane left -> go to middle
+        direction = 1;
+    else if (stream + 1 >= m_numberOfStreams) // Special Case 2: outer lane 
+                                              // right -> go to middle
+        direction = -1;
+    // Move randomly left or right
+    return stream + direction;
+}
+
+int BloodVessel::StreamChangeTarget(unsigned int particleID, int stream,
+                                    uint64_t step) {
+    // TranslateParticles() changes the streams of organs in every second
+    // step. m_streamChangeLoop starts at 1, so these are the odd steps.
+    if (!ChangesStreams() || step % 2 == 0)
+        return -1;
+    if (!WillChangeStream(particleID, step))
+        return -1;
+    return StreamChangeDestination(stream, step);
+}
+
+void BloodVessel::ChangeParticleStream(int curStream, size_t index,
+                                       int desStream) {
+    shared_ptr<Particle> bot = m_bloodstreams[curStream]->RemoveParticle(index);
+    Particle &changed = *bot;
+    m_bloodstreams[desStream]->AddParticle(std::move(bot));
+    if (printer->RecordsEvents())
+        printer->PrintEvent(changed, StreamChangeEvent, m_bloodvesselID);
+}
+
 void BloodVessel::DoChangeStreamIfPossible(int curStream, int desStream) {
-    list<shared_ptr<Particle>> canChange;
-    canChange.clear();
-    for (uint j = 0; j < m_bloodstreams[curStream]->CountParticles(); j++) {
-        if (m_bloodstreams[curStream]->GetParticle(j)->GetShouldChange()) {
+    vector<Particle *> changed;
+    ParticleStore &store = m_bloodstreams[curStream]->GetParticleStore();
+    for (uint j = 0; j < store.Size(); j++) {
+        if (store.GetShouldChange(j)) {
             // set should change back to false
-            m_bloodstreams[curStream]->GetParticle(j)->SetShouldChange(false);
-            m_bloodstreams[desStream]->AddParticle(
-                m_bloodstreams[curStream]->RemoveParticle(j));
+            store.SetShouldChange(j, false);
+            shared_ptr<Particle> bot =
+                m_bloodstreams[curStream]->RemoveParticle(j);
+            changed.push_back(bot.get());
+            m_bloodstreams[desStream]->AddParticle(std::move(bot));
+            j -= 1;
         }
     }
+    if (changed.size() > 0 && printer->RecordsEvents())
+        printer->PrintEvents(changed, StreamChangeEvent, m_bloodvesselID);
     // Sort all Particles by ID
     m_bloodstreams[desStream]->SortStream();
 }
 
-bool BloodVessel::transposeParticle(shared_ptr<Particle> botToTranspose,
-                                   shared_ptr<BloodVessel> thisBloodVessel,
-                                   shared_ptr<BloodVessel> nextBloodVessel,
-                                   int stream) {
-    Position stopPositionOfVessel = thisBloodVessel->
+bool BloodVessel::transposeParticle(Particle &botToTranspose,
+                                    BloodVessel &thisBloodVessel,
+                                    BloodVessel &nextBloodVessel,
+                                    int stream) {
+    Position stopPositionOfVessel = thisBloodVessel.
         GetStopPositionBloodVessel();
-    Position nanobotPosition = botToTranspose->GetPosition();
+    Position nanobotPosition = botToTranspose.GetPosition();
     double distance = sqrt(pow(nanobotPosition.x - stopPositionOfVessel.x, 2) +
                            pow(nanobotPosition.y - stopPositionOfVessel.y, 2) +
                            pow(nanobotPosition.z - stopPositionOfVessel.z, 2));
     distance = distance /
-               thisBloodVessel->m_bloodstreams[stream]->GetVelocity() *
-               nextBloodVessel->m_bloodstreams[stream]->GetVelocity();
-    botToTranspose->SetPosition(nextBloodVessel->GetStartPositionBloodVessel());
-    Position rmp = SetPosition(botToTranspose->GetPosition(), distance,
-                             nextBloodVessel->GetBloodVesselAngle(),
-                             nextBloodVessel->GetBloodVesselType(),
-                             thisBloodVessel->GetStopPositionBloodVessel().z);
-    botToTranspose->SetPosition(rmp);
-    double nbx = botToTranspose->GetPosition().x -
-                 nextBloodVessel->GetStartPositionBloodVessel().x;
-    double nby = botToTranspose->GetPosition().y -
-                 nextBloodVessel->GetStartPositionBloodVessel().y;
+               thisBloodVessel.m_bloodstreams[stream]->GetVelocity() *
+               nextBloodVessel.m_bloodstreams[stream]->GetVelocity();
+    botToTranspose.SetPosition(nextBloodVessel.GetStartPositionBloodVessel());
+    Position rmp = SetPosition(botToTranspose.GetPosition(), distance,
+                             nextBloodVessel.GetBloodVesselAngle(),
+                             nextBloodVessel.GetBloodVesselType(),
+                             thisBloodVessel.GetStopPositionBloodVessel().z);
+    botToTranspose.SetPosition(rmp);
+    double nbx = botToTranspose.GetPosition().x -
+                 nextBloodVessel.GetStartPositionBloodVessel().x;
+    double nby = botToTranspose.GetPosition().y -
+                 nextBloodVessel.GetStartPositionBloodVessel().y;
     double length = sqrt(nbx * nbx + nby * nby);
     // check if position exceeds bloodvessel
-    return length > nextBloodVessel->GetbloodvesselLength() || rmp.z < -2 ||
+    return length > nextBloodVessel.GetbloodvesselLength() || rmp.z < -2 ||
            rmp.z > 2;
 }
 
@@ -344,88 +648,136 @@ bool BloodVessel::NeedsTransferStep() {
     return reachedEndMap.size() > 0;
 }
 
+size_t BloodVessel::CountDepartingParticles() {
+    size_t departing = 0;
+    for (auto & x : reachedEndMap)
+        departing += x.second.size();
+    return departing;
+}
+
 void BloodVessel::PerformTransferStep(){
     for (auto & x : reachedEndMap) {
-        if (x.second.size() > 0) {
-            TransferStep(x.second, x.first);
-        }
+        if (printer->RecordsEvents())
+            printer->PrintEvents(x.second, ExitEvent, m_bloodvesselID);
+        for (shared_ptr<Particle> &botToTranspose : x.second)
+            RouteParticle(std::move(botToTranspose), x.first);
         x.second.clear();
     }
     reachedEndMap.clear();
 }
 
-void BloodVessel::TransferStep(list<shared_ptr<Particle>> reachedEnd, 
-                               int stream) {
-    list<shared_ptr<Particle>> print1;
-    list<shared_ptr<Particle>> print2;
-    list<shared_ptr<Particle>> reachedEndAgain;
-
-    int onetwo = -1;
-    for (const shared_ptr<Particle> &botToTranspose : reachedEnd) {
-        onetwo = Randomizer::GetRandomValue(0,100000);
-        // to v2
-        if (m_nextBloodVessel2 != 0 && (onetwo >= m_transitionto1 * 100000)) {
-            // fits next vessel?
-            if (transposeParticle(botToTranspose, shared_from_this(), 
-                                 m_nextBloodVessel2, stream)) {
-                reachedEndAgain.push_back(botToTranspose);
-                m_nextBloodVessel2->TransferStep(reachedEndAgain, stream);
-                reachedEndAgain.clear();
-            } else {
-                m_nextBloodVessel2->m_bloodstreams[stream]->AddParticle(
-                    botToTranspose);
-                print2.push_back(botToTranspose);
-            }
-        }
-        // to v1
-        else if (m_nextBloodVessel2 == 0 || onetwo < m_transitionto1 * 100000) {
-            // fits next vessel?
-            if (transposeParticle(botToTranspose, shared_from_this(), 
-                                 m_nextBloodVessel1, stream)) {
-                reachedEndAgain.push_back(botToTranspose);
-                m_nextBloodVessel1->TransferStep(reachedEndAgain, stream);
-                reachedEndAgain.clear();
-            } else {
-                m_nextBloodVessel1->m_bloodstreams[stream]->AddParticle(
-                    botToTranspose);
-                print1.push_back(botToTranspose);
-            }
-        }
-        else {
-            cout << "ERROR! Did not transpose particle correctly" << endl;
-        }
+void BloodVessel::RouteParticle(shared_ptr<Particle> botToTranspose,
+                                int stream) {
+    // Only the particle itself is modified, the destination is written to the
+    // inbox.
+    shared_ptr<BloodVessel> next = RouteDeparture(*botToTranspose, stream);
+    m_inboxes[next->GetbloodvesselID()].push_back(
+        {stream, std::move(botToTranspose)});
+}
+
+shared_ptr<BloodVessel> BloodVessel::RouteDeparture(Particle &botToTranspose,
+                                                    int stream) {
+    // Follow the connections until the particle fits into a vessel.
+    BloodVessel *current = this;
+    KeyedRandom random(GlobalTimer::GetStep(), m_bloodvesselID,
+                       botToTranspose.GetParticleID(),
+                       KeyedRandom::TransitionPurpose);
+    while (true) {
+        const shared_ptr<BloodVessel> &next = current->ChooseNextVessel(random);
+        // fits next vessel?
+        if (!transposeParticle(botToTranspose, *current, *next, stream))
+            return next;
+        current = next.get();
     }
+}
+
+const shared_ptr<BloodVessel> &
+BloodVessel::ChooseNextVessel(KeyedRandom &random) {
+    int onetwo = random.GetValue(0, 100000);
+    if (m_nextBloodVessel2 != 0 && onetwo >= m_transitionto1 * 100000)
+        return m_nextBloodVessel2;
+    return m_nextBloodVessel1;
+}
 
-    printer->PrintParticles(print1, m_nextBloodVessel1->GetbloodvesselID());
-    if (m_nextBloodVessel2 != 0)
-        printer->PrintParticles(print2, m_nextBloodVessel2->GetbloodvesselID());
+shared_ptr<Particle> BloodVessel::DepartParticle(int stream, size_t index) {
+    shared_ptr<Particle> bot = m_bloodstreams[stream]->RemoveParticle(index);
+    if (printer->RecordsEvents())
+        printer->PrintEvent(*bot, ExitEvent, m_bloodvesselID);
+    return bot;
 }
 
-list<shared_ptr<Particle>> BloodVessel::GetParticles() {
-    list<shared_ptr<Particle>> bots;
+void BloodVessel::EnterParticle(int stream, shared_ptr<Particle> bot) {
+    Particle &entered = *bot;
+    m_bloodstreams[stream]->AddParticle(std::move(bot));
+    if (printer->RecordsEvents())
+        printer->PrintEvent(entered, EntryEvent, m_bloodvesselID);
+}
+
+void BloodVessel::ReceiveTransfers(
+    const list<shared_ptr<BloodVessel>> &senders) {
+    vector<Particle *> print;
+    vector<Particle *> entries;
+    bool recordStep = printer->RecordsStep(GlobalTimer::GetStep());
+    bool recordEvents = printer->RecordsEvents();
+    for (const shared_ptr<BloodVessel> &sender : senders) {
+        auto inbox = sender->m_inboxes.find(m_bloodvesselID);
+        if (inbox == sender->m_inboxes.end())
+            continue;
+        // the inbox is cleared after the step, its handles move over
+        for (TransferredParticle &transfer : inbox->second) {
+            Particle *bot = transfer.particle.get();
+            m_bloodstreams[transfer.stream]->AddParticle(
+                std::move(transfer.particle));
+            if (recordEvents)
+                entries.push_back(bot);
+            if (recordStep &&
+                printer->RecordsParticle(bot->GetParticleID(),
+                                         bot->particleType))
+                print.push_back(bot);
+        }
+    }
+    if (print.size() > 0)
+        printer->PrintParticles(print, m_bloodvesselID);
+    if (entries.size() > 0)
+        printer->PrintEvents(entries, EntryEvent, m_bloodvesselID);
+}
+
+void BloodVessel::ClearInboxes() { m_inboxes.clear(); }
+
+span<Particle *const> BloodVessel::GetParticles() {
+    m_particleView.clear();
     for (uint j = 0; j < m_bloodstreams.size(); j++) {
-        for (uint i = 0; i < m_bloodstreams[j]->CountParticles(); i++)
-            bots.push_back(m_bloodstreams[j]->GetParticle(i));
+        ParticleStore &store = m_bloodstreams[j]->GetParticleStore();
+        for (uint i = 0; i < store.Size(); i++)
+            m_particleView.push_back(&store.At(i));
     }
-    return bots;
+    return m_particleView;
 }
 
 void BloodVessel::CheckParticleInteractions() {
-    list<shared_ptr<Particle>> bots = GetParticles();
     if (this->GetFingerprintFormationTime() > 0)
-        this->CheckRelease(bots);
+        this->CheckRelease();
     if (this->isActive())
-        this->CheckCollect(bots);
-    this->CheckDetect(bots);
+        this->CheckCollect();
+    this->CheckDetect();
 }
 
 // HELPER
 void BloodVessel::PrintParticlesOfVessel() {
+    // the printed Particles are the first positions of the event output
+    if (printer->RecordsEvents())
+        printer->PrintEvents(GetParticles(), EntryEvent, m_bloodvesselID);
+    if (!printer->RecordsStep(GlobalTimer::GetStep()))
+        return;
+    vector<Particle *> print;
     for (uint j = 0; j < m_bloodstreams.size(); j++) {
-        for (uint i = 0; i < m_bloodstreams[j]->CountParticles(); i++)
-            printer->PrintParticle(m_bloodstreams[j]->GetParticle(i),
-                                  GetbloodvesselID());
+        ParticleStore &store = m_bloodstreams[j]->GetParticleStore();
+        for (uint i = 0; i < store.Size(); i++)
+            if (printer->RecordsParticle(store.GetID(i), store.GetType(i)))
+                print.push_back(&store.At(i));
     }
+    if (print.size() > 0)
+        printer->PrintParticles(print, GetbloodvesselID());
 }
 
 void BloodVessel::initStreams() {
@@ -433,6 +785,7 @@ void BloodVessel::initStreams() {
     shared_ptr<Bloodstream> stream;
     for (i = 0; i < stream_definition_size; i++) {
         stream = make_shared<Bloodstream>();
+        stream->GetParticleStore().SetVesselCounts(&m_counts);
         stream->initBloodstream(m_bloodvesselID, i, stream_definition[i][0],
                                 stream_definition[i][1] / 10.0,
                                 stream_definition[i][2] / 10.0,
@@ -454,10 +807,11 @@ double BloodVessel::CalcLength() {
     }
 }
 
-double BloodVessel::CalcDistance(shared_ptr<Particle> n_1, 
-                                 shared_ptr<Particle> n_2) {
-    Position v_1 = n_1->GetPosition();
-    Position v_2 = n_2->GetPosition();
+double BloodVessel::CalcDistance(Particle &n_1, Particle &n_2) {
+    return CalcDistance(n_1.GetPosition(), n_2.GetPosition());
+}
+
+double BloodVessel::CalcDistance(Position v_1, Position v_2) {
     double l = sqrt(pow(v_1.x - v_2.x, 2) + pow(v_1.y - v_2.y, 2));
     return l;
 }
@@ -477,54 +831,65 @@ void BloodVessel::CountStepsAndAgeCells() {
         int secCount = 1;
         if (m_stepsPerSec < 0)
             secCount = m_deltaT;
-        for (int i = 0; i < m_numberOfStreams; i++) {
-            for (uint j = 0; j < m_bloodstreams[i]->CountParticles(); j++) {
-                shared_ptr<Particle> nb = m_bloodstreams[i]->GetParticle(j);
-                if (nb->CanAge() && !nb->Age(secCount)) {
-                    m_bloodstreams[i]->RemoveParticle(nb);
-                    j -= 1;
-                }
+        AgeCells(secCount);
+    }
+}
+
+void BloodVessel::AgeCells(int seconds) {
+    vector<shared_ptr<Particle>> deaths;
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        for (uint j = 0; j < store.Size(); j++) {
+            if (store.CanAge(j) && !store.GetHandle(j)->Age(seconds)) {
+                deaths.push_back(m_bloodstreams[i]->RemoveParticle(j));
+                j -= 1;
             }
         }
     }
+    if (deaths.size() > 0 && printer->RecordsEvents())
+        printer->PrintEvents(deaths, DeathEvent, m_bloodvesselID);
 }
 
 void BloodVessel::PerformCellMitosis() {
     for (int i = 0; i < m_numberOfStreams; i++) {
-        for (uint j = 0; j < m_bloodstreams[i]->CountParticles(); j++) {
-            shared_ptr<Particle> nb = m_bloodstreams[i]->GetParticle(j);
-            if (nb->WillPerformMitosis()) {
-                switch (nb->particleType) {
-                case CarTCellType: {
-                    Position m_coordinates = 
-                        this->GetStartPositionBloodVessel();
-                    //Position m_coordinates = nb->GetPosition();
-                    shared_ptr<CarTCell> cell = make_shared<CarTCell>();
-                    cell->SetParticleID(IDCounter::GetNextParticleID());
-                    cell->SetShouldChange(false);
-                    cell->SetPosition(Position(m_coordinates.x, 
-                                             m_coordinates.y, 
-                                             m_coordinates.z));
-                    this->AddParticleToStream(i, cell);
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        for (uint j = 0; j < store.Size(); j++) {
+            // only CarTCells and CancerCells perform mitosis
+            switch (store.GetType(j)) {
+            case CarTCellType: {
+                CarTCell &ctc = store.As<CarTCell>(j);
+                if (!ctc.WillPerformMitosis())
                     break;
-                }
-                case CancerCellType: {
-                    Position m_coordinates = 
-                        this->GetStartPositionBloodVessel();
-                    //Position m_coordinates = nb->GetPosition();
-                    shared_ptr<CancerCell> cell = make_shared<CancerCell>();
-                    cell->SetParticleID(IDCounter::GetNextParticleID());
-                    cell->SetShouldChange(false);
-                    cell->SetPosition(Position(m_coordinates.x, 
-                                             m_coordinates.y, 
-                                             m_coordinates.z));
-                    this->AddParticleToStream(i, cell);
-                    break;
-                }
-                default:
+                Position m_coordinates = 
+                    this->GetStartPositionBloodVessel();
+                //Position m_coordinates = nb->GetPosition();
+                shared_ptr<CarTCell> cell = MakePooled<CarTCell>();
+                cell->SetShouldChange(false);
+                cell->SetPosition(Position(m_coordinates.x, 
+                                         m_coordinates.y, 
+                                         m_coordinates.z));
+                m_births.push_back({i, cell});
+                ctc.ResetMitosis();
+                break;
+            }
+            case CancerCellType: {
+                CancerCell &cc = store.As<CancerCell>(j);
+                if (!cc.WillPerformMitosis())
                     break;
-                }
-                nb->ResetMitosis();
+                Position m_coordinates = 
+                    this->GetStartPositionBloodVessel();
+                //Position m_coordinates = nb->GetPosition();
+                shared_ptr<CancerCell> cell = MakePooled<CancerCell>();
+                cell->SetShouldChange(false);
+                cell->SetPosition(Position(m_coordinates.x, 
+                                         m_coordinates.y, 
+                                         m_coordinates.z));
+                m_births.push_back({i, cell});
+                cc.ResetMitosis();
+                break;
+            }
+            default:
+                break;
             }
         }
     }
@@ -559,70 +924,83 @@ void BloodVessel::InitBloodstreamLengthAngleAndVelocity(double velocity) {
                                         stream_definition[i][2] * offset);
         }
     }
+    SetStreamAxes();
 }
 
-void BloodVessel::CheckRelease(list<shared_ptr<Particle>> nbToCheck) {
-    for (const shared_ptr<Particle> &bot : nbToCheck) {
-        if (bot->HasFingerprintLoaded()) {
-            if (bot->GetTargetOrgan() == m_bloodvesselID) {
-                SetFingerprintRelease(m_fingerprintFormationTime);
-                // When one NanoLocator reached the vessel it is assumed that
-                // others will follow and the signal is strong enough. So the
-                // vessel doesn't look for more nanolocators
-                // m_fingerprintFormationflag = false;
-                bot->releaseFingerprintTiles();
+void BloodVessel::CheckRelease() {
+    // only NanoLocators carry fingerprints
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        for (uint j = 0; j < store.Size(); j++) {
+            if (store.GetType(j) != NanolocatorType)
+                continue;
+            NanoLocator &bot = store.As<NanoLocator>(j);
+            if (bot.HasFingerprintLoaded()) {
+                if (bot.GetTargetOrgan() == m_bloodvesselID) {
+                    SetFingerprintRelease(m_fingerprintFormationTime);
+                    // When one NanoLocator reached the vessel it is assumed
+                    // that others will follow and the signal is strong
+                    // enough. So the vessel doesn't look for more
+                    // nanolocators
+                    // m_fingerprintFormationflag = false;
+                    bot.releaseFingerprintTiles();
+                }
             }
         }
     }
 }
 
-void BloodVessel::CheckCollect(list<shared_ptr<Particle>> nbToCheck) {
-    for (const shared_ptr<Particle> &bot : nbToCheck) {
-        // Bot is nanocollector
-        if (bot->particleType == NanocollectorType) {
-            if (bot->GetTargetOrgan() == m_bloodvesselID)
-                // std::cout << "Nanocollector: " << bot->GetParticleID() << "
-                // collects message " << bot->GetTargetOrgan() << std::endl;
-                bot->collectMessage();
+void BloodVessel::CheckCollect() {
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        for (uint j = 0; j < store.Size(); j++) {
+            // Bot is nanocollector
+            if (store.GetType(j) != NanocollectorType)
+                continue;
+            Nanocollector &bot = store.As<Nanocollector>(j);
+            if (bot.GetTargetOrgan() == m_bloodvesselID)
+                bot.collectMessage();
         }
     }
 }
 
-void BloodVessel::CheckDetect(list<shared_ptr<Particle>> nbToCheck) {
-    for (const shared_ptr<Particle> &particle : nbToCheck) {
-        // Bot is nanoparticle
-        if (particle->particleType == NanoparticleType) {
-            double x = particle->GetPosition().x;
-            double y = particle->GetPosition().y;
-            double z = particle->GetPosition().z;
-            double detectionRadius = particle->GetDetectionRadius();
-
-            for (const shared_ptr<Particle> &bot : nbToCheck) {
-                // is Particle
-                if (bot->particleType == BaseParticleType) {
-                    double bx = bot->GetPosition().x;
-                    double by = bot->GetPosition().y;
-                    double bz = bot->GetPosition().z;
-
-                    // calculate distance
-                    double distance =
-                        sqrt(pow(x - bx, 2) + pow(y - by, 2) + pow(z - bz, 2));
-                    // is in radius of Detection
-                    if (distance < detectionRadius)
-                        particle->GetsDetected();
-                }
-            }
+void BloodVessel::CheckDetect() {
+    // the particles that can be detected, bucketed by position
+    m_detectionGrid.Clear();
+    double maxRadius = 0;
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        for (uint j = 0; j < store.Size(); j++) {
+            ParticleType type = store.GetType(j);
+            if (type == BaseParticleType)
+                m_detectionGrid.Insert(store.GetPosition(j));
+            else if (type == NanoparticleType)
+                maxRadius = max(maxRadius, store.GetDetectionRadius(j));
         }
     }
-}
+    if (m_detectionGrid.Size() == 0 || maxRadius <= 0)
+        return;
+    m_detectionGrid.SetCellSize(maxRadius);
+    m_detectionGrid.Build();
 
-bool BloodVessel::IsEmpty() {
-    bool empty = true;
-    for (int i = 0; i < m_numberOfStreams; i++)
-        empty = empty && m_bloodstreams[i]->IsEmpty();
-    return empty;
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        for (uint j = 0; j < store.Size(); j++) {
+            // Bot is nanoparticle
+            if (store.GetType(j) != NanoparticleType)
+                continue;
+            // every Particle in radius of detection counts once
+            size_t detected = m_detectionGrid.CountWithin(
+                store.GetPosition(j), store.GetDetectionRadius(j));
+            Nanoparticle &particle = store.As<Nanoparticle>(j);
+            for (size_t k = 0; k < detected; k++)
+                particle.GetsDetected();
+        }
+    }
 }
 
+bool BloodVessel::IsEmpty() { return m_counts.total == 0; }
+
 int BloodVessel::GetbloodvesselID() { return m_bloodvesselID; }
 
 void BloodVessel::SetBloodVesselID(int b_id) { m_bloodvesselID = b_id; }
@@ -641,7 +1019,10 @@ void BloodVessel::SetVesselWidth(double value) { m_vesselWidth = value; }
 
 void BloodVessel::AddParticleToStream(unsigned int streamID, 
                                      shared_ptr<Particle> bot) {
-    m_bloodstreams[streamID]->AddParticle(bot);
+    Particle &added = *bot;
+    m_bloodstreams[streamID]->AddParticle(std::move(bot));
+    if (printer->RecordsEvents())
+        printer->PrintEvent(added, BirthEvent, m_bloodvesselID);
 }
 
 BloodVesselType BloodVessel::GetBloodVesselType() { return m_bloodvesselType; }
@@ -711,13 +1092,13 @@ bool BloodVessel::isActive() { return m_hasActiveFingerprintMessage; }
 void BloodVessel::ReleaseParticles() {
     // release more particles
     shared_ptr<RandomStream> distribute_randomly =
-        Randomizer::GetNewRandomStream(0, this->GetNumberOfStreams());
+        Randomizer::GetNewRandomStream(0, this->GetNumberOfStreams(),
+                                       m_bloodvesselID, 1);
     // release particles from the liver Organ 36
     for (int i = 1; i <= 100; ++i) {
         // shared_ptr<BloodVessel> liver = m_bloodvessels[36];
         Position m_coordinateLiver = this->GetStartPositionBloodVessel();
-        shared_ptr<Particle> temp_np = make_shared<Nanoparticle>();
-        temp_np->SetParticleID(IDCounter::GetNextParticleID());
+        shared_ptr<Particle> temp_np = MakePooled<Nanoparticle>();
         // Get random stream number.
         int dr = floor(distribute_randomly->GetValue());
         temp_np->SetShouldChange(false);
@@ -727,25 +1108,101 @@ void BloodVessel::ReleaseParticles() {
         temp_np->SetDelay(2.32);
         temp_np->SetDetectionRadius(0.2);
         // Set position with random stream dr.
-        this->AddParticleToStream(dr, temp_np);
+        m_births.push_back({dr, temp_np});
+    }
+}
+
+void BloodVessel::SaveState(ostream &out) {
+    WriteState(out, injection.m_injectionTime);
+    WriteState(out, injection.m_injectionVessel);
+    WriteState(out, injection.m_injectionNumber);
+    WriteState(out, m_secStepCounter);
+    WriteState(out, m_streamChangeLoop);
+    WriteState(out, m_fingerPrintTimer);
+    WriteState(out, m_hasActiveFingerprintMessage);
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        uint64_t count = store.Size();
+        WriteState(out, count);
+        for (size_t j = 0; j < store.Size(); j++) {
+            Particle &bot = store.At(j);
+            WriteState(out, (int)bot.particleType);
+            bot.SaveState(out);
+        }
+    }
+}
+
+void BloodVessel::LoadState(istream &in) {
+    ReadState(in, injection.m_injectionTime);
+    ReadState(in, injection.m_injectionVessel);
+    ReadState(in, injection.m_injectionNumber);
+    ReadState(in, m_secStepCounter);
+    ReadState(in, m_streamChangeLoop);
+    ReadState(in, m_fingerPrintTimer);
+    ReadState(in, m_hasActiveFingerprintMessage);
+    for (int i = 0; i < m_numberOfStreams; i++) {
+        ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+        store.Clear();
+        uint64_t count;
+        ReadState(in, count);
+        for (uint64_t j = 0; j < count; j++) {
+            int type;
+            ReadState(in, type);
+            shared_ptr<Particle> bot = CreateParticle((ParticleType)type);
+            bot->LoadState(in);
+            // Add() projects the position, which already contains the offset
+            // of the stream, the saved arc length is exact
+            double arc = bot->GetArcLength();
+            store.Add(bot);
+            store.SetArc(store.Size() - 1, arc);
+        }
+    }
+}
+
+shared_ptr<Particle> BloodVessel::CreateParticle(ParticleType type) {
+    switch (type) {
+    case NanoparticleType:
+        return MakePooled<Nanoparticle>();
+    case NanocollectorType:
+        return MakePooled<Nanocollector>();
+    case NanolocatorType:
+        return MakePooled<NanoLocator>();
+    case CancerCellType:
+        return MakePooled<CancerCell>();
+    case CarTCellType:
+        return MakePooled<CarTCell>();
+    case TCellType:
+        return MakePooled<TCell>();
+    default:
+        throw runtime_error("Checkpoint contains an unknown particle type " +
+                            to_string(type));
     }
 }
 
 void BloodVessel::PerformInjection() {
     shared_ptr<RandomStream> distribute_randomly =
-        Randomizer::GetNewRandomStream(0, this->GetNumberOfStreams());
+        Randomizer::GetNewRandomStream(0, this->GetNumberOfStreams(),
+                                       m_bloodvesselID, 0);
+    ReservePooled<CarTCell>(injection.m_injectionNumber);
     for (int i = 1; i <= injection.m_injectionNumber; ++i) {
         Position m_coordinates = this->GetStartPositionBloodVessel();
-        shared_ptr<CarTCell> cell = make_shared<CarTCell>();
-        cell->SetParticleID(IDCounter::GetNextParticleID());
+        shared_ptr<CarTCell> cell = MakePooled<CarTCell>();
         cell->SetShouldChange(false);
         cell->SetPosition(
             Position(m_coordinates.x, m_coordinates.y, m_coordinates.z));
         int dr = floor(distribute_randomly->GetValue());
-        this->AddParticleToStream(dr, cell);
+        m_births.push_back({dr, cell});
     }
 }
 
+void BloodVessel::AddBirths() {
+    for (TransferredParticle &birth : m_births) {
+        birth.particle->SetParticleID(IDCounter::GetNextParticleID());
+        this->AddParticleToStream(birth.stream, std::move(birth.particle));
+    }
+    m_births.clear();
+}
+
 void BloodVessel::AddCarTCellInjection(int injectionTime, int injectionVessel,
                                        int numberOfCarTCells) {
     injection.m_injectionTime = injectionTime;
@@ -753,30 +1210,77 @@ void BloodVessel::AddCarTCellInjection(int injectionTime, int injectionVessel,
     injection.m_injectionNumber = numberOfCarTCells;
 }
 
-int BloodVessel::CountCancerCells() {
-    int cancerCells = 0;
-    for (int i = 0; i < m_numberOfStreams; i++)
-        cancerCells += m_bloodstreams[i]->CountCancerCells();
-    return cancerCells;
+CarTCell::CarTCellInjection BloodVessel::GetCarTCellInjection() {
+    return injection;
+}
+
+vector<pair<shared_ptr<BloodVessel>, double>> BloodVessel::GetSuccessors() {
+    vector<pair<shared_ptr<BloodVessel>, double>> successors;
+    if (m_nextBloodVessel2 == 0) {
+        if (m_nextBloodVessel1 != 0)
+            successors.push_back({m_nextBloodVessel1, 1});
+        return successors;
+    }
+    double first = clamp(m_transitionto1, 0.0, 1.0);
+    if (m_nextBloodVessel1 != 0)
+        successors.push_back({m_nextBloodVessel1, first});
+    successors.push_back({m_nextBloodVessel2, 1 - first});
+    return successors;
+}
+
+double BloodVessel::MeanResidenceTime(int i) {
+    ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+    double length =
+        store.GetArcMax() - store.ArcOf(m_startPositionBloodVessel);
+    // the velocity offsets of SampleStepDistance() average out
+    double velocity = m_bloodstreams[i]->GetVelocity();
+    if (!isfinite(length) || length <= 0 || velocity <= 0)
+        return 0;
+    return length / velocity;
+}
+
+Position BloodVessel::PositionInStream(int i, double fraction) {
+    ParticleStore &store = m_bloodstreams[i]->GetParticleStore();
+    double start = store.ArcOf(m_startPositionBloodVessel);
+    double end = store.GetArcMax();
+    if (!isfinite(end) || end <= start)
+        return store.PositionAt(start);
+    return store.PositionAt(start + (end - start) * fraction);
 }
 
-int BloodVessel::CountCarTCells() {
-    int carTCells = 0;
-    for (int i = 0; i < m_numberOfStreams; i++)
-        carTCells += m_bloodstreams[i]->CountCarTCells();
-    return carTCells;
+bool BloodVessel::HasInjectionUntil(uint64_t timeInS) {
+    return injection.m_injectionVessel > 0 &&
+           injection.m_injectionTime <= (double)timeInS;
 }
 
+size_t BloodVessel::CountParticles() { return m_counts.total; }
+
+size_t BloodVessel::CountType(ParticleType type) {
+    return m_counts.types[type];
+}
+
+int BloodVessel::CountCancerCells() { return m_counts.types[CancerCellType]; }
+
+int BloodVessel::CountCarTCells() { return m_counts.types[CarTCellType]; }
+
+int BloodVessel::CountActiveCarTCells() { return m_counts.activeCarTCells; }
+
 void BloodVessel::ExchangeParticles(std::vector<shared_ptr<Particle>> newBots) {
     int numStreams = m_bloodstreams.size();
     for (int i = 0; i < numStreams; i++)
         m_bloodstreams[i]->ClearStream();
     
     for (std::shared_ptr<Particle> bot : newBots) {
-        if (bot->GetStream() >= 0)
+        if (bot->GetStream() >= 0) {
             m_bloodstreams[bot->GetStream()]->AddParticle(bot);
-        else
-            m_bloodstreams[Randomizer::GetRandomIntegerValue(0,numStreams)]->AddParticle(bot);
+        } else {
+            KeyedRandom random(GlobalTimer::GetStep(), m_bloodvesselID,
+                               bot->GetParticleID(),
+                               KeyedRandom::ExchangePurpose);
+            // any of the streams 0 to numStreams - 1
+            m_bloodstreams[random.GetIntegerValue(0, numStreams - 1)]
+                ->AddParticle(bot);
+        }
     }
 }
 
@@ -34,9 +34,13 @@
 #include "../utils/IDCounter.h"
 #include "../utils/Position.h"
 #include "../utils/GlobalTimer.h"
+#include "../utils/PoolAllocator.h"
+#include "../utils/SpatialGrid.h"
+#include "../utils/StateIO.h"
 #include <random>
 #include <memory>
 #include <map>
+#include <span>
 #include <math.h>
 
 using namespace std;
@@ -55,9 +59,27 @@ namespace bloodcircuit {
  * on). Particles are added to the BloodVessels in BloodCircuit.
  */
 enum BloodVesselType { ARTERY, VEIN, ORGAN };
+
+// A Particle that left its vessel, buffered until the receiving vessel
+// collects it during the transfer phase.
+struct TransferredParticle {
+    int stream;
+    shared_ptr<Particle> particle;
+};
+
+// A cell taking part in the CarTCell interactions of one step. The index
+// into m_interactionCells equals the id of the cell in the interaction grid.
+struct InteractionCell {
+    int stream;
+    size_t index;        // index in the ParticleStore of the stream
+    ParticleType type;
+    bool removed;        // killed or dead, removed after the interactions
+};
+
 class BloodVessel: public enable_shared_from_this<BloodVessel>{
 private:
     // bool m_start;
+    ParticleCounts m_counts; // Particles of all streams, kept by the streams
     vector<shared_ptr<Bloodstream>> m_bloodstreams; // list of nanobots in streams
     int m_bloodvesselID;                     // unique ID, set in bloodcircuit
     double m_bloodvesselLength;              // the length of the bloodvessel
@@ -79,6 +101,7 @@ private:
                           // (duration between each step)
     double m_stepsPerSec; // number of steps per second
     int m_secStepCounter; // counts steps in each second
+    int m_streamChangeLoop; // streams are changed every second step
 
     // Fingerprint functionality
     double m_fingerprintFormationTime;  // out of csv, time that a message
@@ -92,7 +115,19 @@ private:
     // Connections
     shared_ptr<BloodVessel> m_nextBloodVessel1;
     shared_ptr<BloodVessel> m_nextBloodVessel2;
-    std::map<int, list<shared_ptr<Particle>>> reachedEndMap;
+    std::map<int, vector<shared_ptr<Particle>>> reachedEndMap;
+    // departing particles by ID of the receiving vessel
+    std::map<int, vector<TransferredParticle>> m_inboxes;
+    // cells created during the step, they get their IDs in AddBirths()
+    vector<TransferredParticle> m_births;
+    // the view returned by GetParticles(), reused between steps
+    vector<Particle *> m_particleView;
+
+    // CarTCell interactions, rebuilt every step
+    SpatialGrid m_interactionGrid;             // cells by position
+    vector<InteractionCell> m_interactionCells;
+    vector<size_t> m_interactionCandidates;    // scratch for grid queries
+    SpatialGrid m_detectionGrid;               // particles for CheckDetect
 
     // Transition probabilities for connections
     double m_transitionto1; // probability blood flows to first vessel
@@ -138,7 +173,9 @@ private:
     // calculate Length
     double CalcLength();
 
-    double CalcDistance(shared_ptr<Particle> n_1, shared_ptr<Particle> n_2);
+    double CalcDistance(Particle &n_1, Particle &n_2);
+
+    double CalcDistance(Position v_1, Position v_2);
 
     /**
      * \param value the Number of Streams the bloodvessel can have.
@@ -161,21 +198,68 @@ private:
     /// stream.
     void DoChangeStreamIfPossible(int curStream, int desStream);
 
+    /// \returns true if the Particle is flagged to change its stream in the
+    /// stream change of the given step.
+    bool WillChangeStream(unsigned int particleID, uint64_t step);
+
+    /// \returns the stream the flagged Particles of stream change to in the
+    /// stream change of the given step.
+    int StreamChangeDestination(int stream, uint64_t step);
+
     /// Transposes Particles from one bloodvessel to another.
     //void TransposeParticles(list<shared_ptr<Particle>> reachedEnd, int i);
 
+    /// Determines the vessel a departed Particle ends up in and places it in
+    /// the inbox for that vessel.
+    void RouteParticle(shared_ptr<Particle> botToTranspose, int stream);
 
-    void TransferStep(list<shared_ptr<Particle>> reachedEnd, int stream);
+    /// Prints the cell counts of a gateway vessel.
+    void PrintGateway(int numCancerCells, int numCarTCells);
 
     /// Moves one Particle to the next bloodvessel
-    bool transposeParticle(shared_ptr<Particle> botToTranspose,
-                          shared_ptr<BloodVessel> thisBloodVessel,
-                          shared_ptr<BloodVessel> nextBloodVessel, int stream);
+    bool transposeParticle(Particle &botToTranspose,
+                           BloodVessel &thisBloodVessel,
+                           BloodVessel &nextBloodVessel, int stream);
+    /**
+     * Calculates how far a Particle in stream i moves in one step of length
+     * dt, with a velocity offset drawn for the Particle and the step.
+     * \return the distance along the vessel.
+     */
+    double CalcStepDistance(unsigned int particleID, int i, double delay,
+                            uint64_t step, double dt);
+
+    /// Sets the axes of the streams, along which their Particles move, and
+    /// the arc lengths at which Particles leave the vessel.
+    void SetStreamAxes();
+
+    /**
+     * Lets every CarTCell interact with the CancerCells, TCells and other
+     * CarTCells within their detection radius and removes the killed cells.
+     * \param seconds the interactions last, the kill and mitosis
+     * probabilities apply per second.
+     */
+    void PerformCellInteractions(int seconds = 1);
+
+    /**
+     * Draws the kills and the mitosis of every encounter of a CarTCell
+     * separately.
+     */
+    void PerformPairwiseInteractions(
+        const map<ParticleType, size_t> &typeCounts, double maxRadius,
+        int seconds);
+
+    /**
+     * Draws the number of kills per target type and the number of mitoses
+     * from binomial distributions, then picks the affected cells uniformly.
+     */
+    void PerformBatchInteractions(const map<ParticleType, size_t> &typeCounts,
+                                  double maxRadius, int seconds);
+
     /**
-     * /return TRUE if position exceeds bloodvessel
+     * \returns true if the cell t of m_interactionCells is within the
+     * detection radius of the CarTCell c.
      */
-    bool moveParticle(shared_ptr<Particle> nb, int i, int randVelocityOffset,
-                     bool direction, double dt);
+    bool IsInDetectionRange(size_t c, size_t t);
 
 
     /**
@@ -204,7 +288,14 @@ private:
 
     void CheckParticleInteractions();
 
+    /// \returns a new Particle of type, restored by LoadState().
+    static shared_ptr<Particle> CreateParticle(ParticleType type);
+
 public:
+    // interactions are sampled in batches per vessel and step, see
+    // PerformBatchInteractions()
+    static bool batchInteractions;
+
     /**
      * Setting the default values:
      * dt=1.0, number of streams=3, changing stream set to true, velocity and
@@ -219,11 +310,135 @@ public:
 
     shared_ptr<BloodVessel> Step(uint64_t timeInMS);
 
+    /**
+     * Performs the interactions, aging, mitoses and injections of seconds
+     * at once, without moving the Particles. Used by the transit-time mode.
+     */
+    void StepCoarse(uint64_t timeInS, int seconds);
+
+    /// First transfer phase: moves the Particles that reached the end of the
+    /// vessel into the inboxes of their destination vessels.
     void PerformTransferStep();
 
     bool NeedsTransferStep();
 
-    list<shared_ptr<Particle>> GetParticles();
+    /**
+     * \returns the number of Particles that reached the end of the vessel in
+     * the last step and wait for the transfer.
+     */
+    size_t CountDepartingParticles();
+
+    /// Second transfer phase: adds the Particles of all inboxes addressed to
+    /// this vessel, in the order of the given senders.
+    void ReceiveTransfers(const list<shared_ptr<BloodVessel>> &senders);
+
+    void ClearInboxes();
+
+    /// Gives the cells created during the last step their IDs and adds them
+    /// to their streams. Called for all vessels in ID order after a step, so
+    /// the IDs do not depend on the number of threads.
+    void AddBirths();
+
+    /**
+     * Moves an arc length like TranslatePosition() moves a Particle in the
+     * given step, used to rebuild positions from the event output.
+     * \param arc arc length in the stream, moved.
+     * \param position set to the position at the moved arc length.
+     * \returns true if the arc length exceeds the vessel.
+     */
+    bool ReplayMovement(unsigned int particleID, int stream, double delay,
+                        uint64_t step, double &arc, Position &position);
+
+    /**
+     * Moves an arc length like TranslatePosition() moves a Particle in the
+     * given step.
+     * \returns true if the arc length exceeds the vessel.
+     */
+    bool PredictMovement(unsigned int particleID, int stream, double delay,
+                         uint64_t step, double &arc);
+
+    /**
+     * \returns the stream the Particle in stream moves to in the stream
+     * change of the given step, or -1 if it stays.
+     */
+    int StreamChangeTarget(unsigned int particleID, int stream, uint64_t step);
+
+    /**
+     * \returns the distance a Particle in stream i moves in one step of
+     * length dt, with the velocity offset drawn from random.
+     */
+    double SampleStepDistance(int i, double delay, double dt,
+                              KeyedRandom &random);
+
+    /**
+     * \returns the stream a Particle in stream changes to, to the left or
+     * right. The outer streams change to the middle.
+     */
+    int NeighbourStream(int stream, bool left);
+
+    /// \returns true if the Particles of the vessel change their streams.
+    bool ChangesStreams();
+
+    /**
+     * \returns the vessel a Particle leaving this vessel moves to, chosen
+     * with the transition probabilities.
+     */
+    const shared_ptr<BloodVessel> &ChooseNextVessel(KeyedRandom &random);
+
+    /**
+     * \returns the vessels ChooseNextVessel() may return, with their
+     * probabilities.
+     */
+    vector<pair<shared_ptr<BloodVessel>, double>> GetSuccessors();
+
+    /**
+     * \returns the mean time in seconds a Particle without delay needs to pass
+     * stream i from the vessel start, or 0 if it leaves at once.
+     */
+    double MeanResidenceTime(int i);
+
+    /**
+     * \returns the position at fraction of the way from the vessel start to
+     * the end of stream i.
+     */
+    Position PositionInStream(int i, double fraction);
+
+    /// \returns true if the vessel prints its cell counts in every step.
+    bool ReportsGateway();
+
+    /// Prints the current cell counts to the gateway output.
+    void PrintGatewayCounts();
+
+    /// \returns true if CarTCells are injected into the vessel until timeInS.
+    bool HasInjectionUntil(uint64_t timeInS);
+
+    /// Writes what changes during a simulation: the Particles of all streams,
+    /// the pending injection and the step and fingerprint timers.
+    void SaveState(ostream &out);
+
+    /// Replaces the Particles and timers by the ones written by SaveState().
+    void LoadState(istream &in);
+
+    // Transitions of single Particles for the event-driven mode. They print
+    // the same events as the steps do.
+
+    /// Removes the Particle at index of stream, it reached the vessel end.
+    shared_ptr<Particle> DepartParticle(int stream, size_t index);
+
+    /// Moves a departed Particle into the vessel it ends up in.
+    /// \returns that vessel, the Particle is not added to it yet.
+    shared_ptr<BloodVessel> RouteDeparture(Particle &bot, int stream);
+
+    /// Adds a routed Particle to stream.
+    void EnterParticle(int stream, shared_ptr<Particle> bot);
+
+    /// Moves the Particle at index of curStream to desStream.
+    void ChangeParticleStream(int curStream, size_t index, int desStream);
+
+    /// \returns all Particles of the vessel with their positions written
+    /// back. The view is valid until the next call or until Particles are
+    /// added or removed, the streams keep the ownership.
+    span<Particle *const> GetParticles();
     /* 
      * Prints all nanobots in the BloodVessel to a csv file.
      */
@@ -240,16 +455,39 @@ public:
      */
     void AddParticleToStream(unsigned int streamID, shared_ptr<Particle> bot);
 
-    void CheckRelease(list<shared_ptr<Particle>> nbToCheck);
+    /// Starts the fingerprint release if a NanoLocator carrying one reached
+    /// its target organ.
+    void CheckRelease();
 
     void CountStepsAndAgeCells();
 
+    /// Ages the cells by seconds and removes the dead ones.
+    void AgeCells(int seconds);
+
+    /// Performs the injection of CarTCells if its time has come.
+    void CheckInjection(uint64_t timeInS);
+
     void PerformCellMitosis();
     
+    /**
+     * \returns the number of Particles in all streams of the vessel.
+     */
+    size_t CountParticles();
+
+    /**
+     * \returns the number of Particles of the given type in the vessel.
+     */
+    size_t CountType(ParticleType type);
+
     int CountCancerCells();
 
     int CountCarTCells();
 
+    /**
+     * \returns the number of CarTCells in the vessel that have killed.
+     */
+    int CountActiveCarTCells();
+
     /**
      * \param Id of a Stream
      * \returns a specific stream
@@ -351,23 +589,24 @@ public:
     /**
      * Checks if the Particle is of type nanocollector and in it's target organ.
      * If the target organ has message molecules active, the collector collects
-     * them and turns it's tissue detected attribute to true. \param value list
-     * of Particles that need to get checked.
+     * them and turns it's tissue detected attribute to true.
      */
-    void CheckCollect(list<shared_ptr<Particle>> nbToCheck);
+    void CheckCollect();
 
     /**
      * Checks if the Particle is of type Particle and if there are Particles in
      * its range to detect it. If the Particle is detected, its count goes up.
-     * \param value list of Particles that need to get checked.
      */
-    void CheckDetect(list<shared_ptr<Particle>> nbToCheck);
+    void CheckDetect();
 
     void ReleaseParticles();
 
     void AddCarTCellInjection(int injectionTime, int injectionVessel,
                               int numberOfCarTCells);
 
+    /// \returns the pending injection, a vessel of -1 if there is none.
+    CarTCell::CarTCellInjection GetCarTCellInjection();
+
     void ExchangeParticles(std::vector<shared_ptr<Particle>> newBots);
 };
 }; // namespace bloodcircuit
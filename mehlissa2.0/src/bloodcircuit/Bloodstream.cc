@@ -24,7 +24,7 @@ namespace bloodcircuit {
 Bloodstream::Bloodstream() {}
 
 Bloodstream::~Bloodstream() {
-    this->m_nanobots.erase(this->m_nanobots.begin(), this->m_nanobots.end());
+    this->m_nanobots.Clear();
 }
 
 void Bloodstream::initBloodstream(int vesselId, int streamId,
@@ -36,49 +36,46 @@ void Bloodstream::initBloodstream(int vesselId, int streamId,
     m_offset_x = offsetX;
     m_offset_y = offsetY;
     m_offset_z = 0;
+    m_nanobots.SetStream(streamId);
 }
     
 void Bloodstream::ClearStream() {
-    this->m_nanobots.erase(this->m_nanobots.begin(), this->m_nanobots.end());
+    this->m_nanobots.Clear();
 }
 
 
-size_t Bloodstream::CountParticles(void) { return this->m_nanobots.size(); }
+size_t Bloodstream::CountParticles(void) { return this->m_nanobots.Size(); }
 
 int Bloodstream::CountCarTCells() {
-    int carTCells = 0;
-    list<shared_ptr<Particle>>::iterator bots = this->m_nanobots.begin();
-    for (unsigned int i = 0; i < m_nanobots.size(); i++) {
-        if ((*bots)->particleType == CarTCellType)
-            carTCells += 1;
-        advance(bots, 1);
-    }
-    return carTCells;
+    return m_nanobots.CountType(CarTCellType);
 }
 
 int Bloodstream::CountCancerCells() {
-    int cancerCells = 0;
-    list<shared_ptr<Particle>>::iterator bots = this->m_nanobots.begin();
-    for (unsigned int i = 0; i < m_nanobots.size(); i++) {
-        if ((*bots)->particleType == CancerCellType)
-            cancerCells += 1;
-        advance(bots, 1);
-    }
-    return cancerCells;
+    return m_nanobots.CountType(CancerCellType);
 }
 
 shared_ptr<Particle> Bloodstream::GetParticle(int index) {
-    list<shared_ptr<Particle>>::iterator i = this->m_nanobots.begin();
-    advance(i, index);
-    return *i;
+    return m_nanobots.Get(index);
 }
 
+ParticleStore &Bloodstream::GetParticleStore() { return m_nanobots; }
+
 shared_ptr<Particle> Bloodstream::RemoveParticle(int index) {
-    return RemoveParticle(GetParticle(index));
+    // swap-remove: the last Particle of the stream takes the free index
+    shared_ptr<Particle> bot = m_nanobots.Remove(index);
+    Position v = bot->GetPosition();
+    v.x -= m_offset_x;
+    v.y -= m_offset_y;
+    v.z -= m_offset_z;
+    bot->SetPosition(v);
+    return bot;
 }
 
-shared_ptr<Particle> Bloodstream::RemoveParticle(shared_ptr<Particle> bot) {
-    m_nanobots.remove(bot);
+shared_ptr<Particle>
+Bloodstream::RemoveParticle(const shared_ptr<Particle> &bot) {
+    int index = m_nanobots.Find(bot);
+    if (index >= 0)
+        return RemoveParticle(index);
     Position v = bot->GetPosition();
     v.x -= m_offset_x;
     v.y -= m_offset_y;
@@ -88,14 +85,17 @@ shared_ptr<Particle> Bloodstream::RemoveParticle(shared_ptr<Particle> bot) {
 }
 
 void Bloodstream::AddParticle(shared_ptr<Particle> bot) {
-    const std::lock_guard<std::mutex> lock(m_addStepMutex);
-    m_nanobots.push_back(bot);
     bot->SetStream(m_currentStream);
     Position v = bot->GetPosition();
     v.x += m_offset_x;
     v.y += m_offset_y;
     v.z += m_offset_z;
     bot->SetPosition(v);
+    m_nanobots.Add(std::move(bot));
+}
+
+Position Bloodstream::GetOffset() {
+    return Position(m_offset_x, m_offset_y, m_offset_z);
 }
 
 void Bloodstream::SetAngle(double angle, double offsetX, double offsetY) {
@@ -110,9 +110,9 @@ void Bloodstream::SetAngle(double angle, double offsetX, double offsetY) {
     }
 }
 
-void Bloodstream::SortStream(void) { m_nanobots.sort(particles::Particle::Compare); }
+void Bloodstream::SortStream(void) { m_nanobots.SortByID(); }
 
-bool Bloodstream::IsEmpty(void) { return m_nanobots.size() <= 0; }
+bool Bloodstream::IsEmpty(void) { return m_nanobots.IsEmpty(); }
 
 double Bloodstream::GetVelocity(void) { return m_velocity; }
 
@@ -20,15 +20,17 @@
 #ifndef CLASS_BLOODSTREAM_
 #define CLASS_BLOODSTREAM_
 
+#include "ParticleStore.h"
 #include "../particles/Particle.h"
 #include "../particles/Nanocollector.h"
 #include "../particles/Nanolocator.h"
 #include "../particles/Nanoparticle.h"
 #include "../utils/Position.h"
+#include <algorithm>
 #include <memory>
 #include <cmath>
+#include <vector>
 #include <omp.h>
-#include <mutex>
 
 using namespace std;
 using namespace particles;
@@ -49,8 +51,9 @@ private:
     double m_offset_x;
     double m_offset_y;
     double m_offset_z;
-    list<shared_ptr<Particle>> m_nanobots;
-    mutex m_addStepMutex;
+    // Particles of the stream, removal swaps the last Particle into the gap,
+    // so the order is only kept by SortStream.
+    ParticleStore m_nanobots;
 
 public:
     Bloodstream(void);
@@ -85,14 +88,22 @@ public:
     shared_ptr<Particle> GetParticle(int index);
 
     /**
-     * \param index: ParticleID
+     * \returns the structure of arrays holding the Particles of the stream.
+     */
+    ParticleStore &GetParticleStore();
+
+    /**
+     * Removes the Particle in O(1), the last Particle of the stream moves to
+     * the given index.
+     * \param index: position of the Particle in the stream
      */
     shared_ptr<Particle> RemoveParticle(int index);
 
     /**
+     * Searches the Particle in the stream, prefer removing by index.
      * \param bot: pointer to bot
      */
-    shared_ptr<Particle> RemoveParticle(shared_ptr<Particle> bot);
+    shared_ptr<Particle> RemoveParticle(const shared_ptr<Particle> &bot);
 
     /**
      * \param bot: pointer to bot
@@ -126,6 +137,11 @@ public:
      */
     void SetAngle(double angle, double offsetX, double offsetY);
 
+    /**
+     * \returns the offset of the stream from the axis of the vessel.
+     */
+    Position GetOffset(void);
+
 }; //  Class End
 }; // namespace bloodcircuit
 #endif
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "ParticleStore.h"
+#include "../particles/CarTCell.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace bloodcircuit {
+
+ParticleStore::ParticleStore() {
+    m_stream = 0;
+    m_vesselCounts = nullptr;
+    m_origin = Position(0, 0, 0);
+    m_direction = Position(1, 0, 0);
+    m_arcMin = -numeric_limits<double>::infinity();
+    m_arcMax = numeric_limits<double>::infinity();
+}
+
+ParticleStore::~ParticleStore() {
+    // the vessel may be destroyed already
+    m_vesselCounts = nullptr;
+    Clear();
+}
+
+void ParticleStore::SetStream(int stream) { m_stream = stream; }
+
+void ParticleStore::SetAxis(Position origin, Position direction,
+                            double arcMin, double arcMax) {
+    m_origin = origin;
+    m_direction = direction;
+    m_arcMin = arcMin;
+    m_arcMax = arcMax;
+}
+
+double ParticleStore::ArcOf(Position position) {
+    double norm = m_direction.x * m_direction.x +
+                  m_direction.y * m_direction.y +
+                  m_direction.z * m_direction.z;
+    // a stream that does not move keeps its Particles at the origin
+    if (norm == 0)
+        return 0;
+    return ((position.x - m_origin.x) * m_direction.x +
+            (position.y - m_origin.y) * m_direction.y +
+            (position.z - m_origin.z) * m_direction.z) /
+           norm;
+}
+
+void ParticleStore::SetVesselCounts(ParticleCounts *counts) {
+    m_vesselCounts = counts;
+}
+
+void ParticleStore::UpdateCounts(ParticleType type, bool active, int count) {
+    for (ParticleCounts *counts : {&m_counts, m_vesselCounts}) {
+        if (counts == nullptr)
+            continue;
+        counts->types[type] += count;
+        counts->total += count;
+        if (active)
+            counts->activeCarTCells += count;
+    }
+}
+
+void ParticleStore::SetActive(size_t index) {
+    if (m_flags[index] & ActiveFlag)
+        return;
+    m_flags[index] |= ActiveFlag;
+    m_counts.activeCarTCells++;
+    if (m_vesselCounts != nullptr)
+        m_vesselCounts->activeCarTCells++;
+}
+
+void ParticleStore::Clear() {
+    if (m_vesselCounts != nullptr) {
+        for (size_t type = 0; type <= SwitchableParticleType; type++)
+            m_vesselCounts->types[type] -= m_counts.types[type];
+        m_vesselCounts->total -= m_counts.total;
+        m_vesselCounts->activeCarTCells -= m_counts.activeCarTCells;
+    }
+    m_counts = ParticleCounts();
+    m_handles.clear();
+    m_ids.clear();
+    m_arcs.clear();
+    m_types.clear();
+    m_delays.clear();
+    m_radii.clear();
+    m_timeSteps.clear();
+    m_flags.clear();
+}
+
+void ParticleStore::Add(shared_ptr<Particle> bot) {
+    double arc = ArcOf(bot->GetPosition());
+    bot->SetPosition(PositionAt(arc));
+    bot->SetArcLength(arc);
+    uint8_t flags = 0;
+    if (bot->CanAge())
+        flags |= CanAgeFlag;
+    if (bot->GetShouldChange())
+        flags |= ShouldChangeFlag;
+    if (bot->particleType == CarTCellType &&
+        static_cast<CarTCell &>(*bot).IsActive())
+        flags |= ActiveFlag;
+    UpdateCounts(bot->particleType, flags & ActiveFlag, 1);
+    m_ids.push_back(bot->GetParticleID());
+    m_arcs.push_back(arc);
+    m_types.push_back(bot->particleType);
+    m_delays.push_back(bot->GetDelay());
+    m_radii.push_back(bot->GetDetectionRadius());
+    m_timeSteps.push_back(bot->GetTimeStepInSeconds());
+    m_flags.push_back(flags);
+    m_handles.push_back(std::move(bot));
+}
+
+void ParticleStore::Sync(size_t index) {
+    Particle *bot = m_handles[index].get();
+    bot->SetPosition(PositionAt(m_arcs[index]));
+    bot->SetArcLength(m_arcs[index]);
+    bot->SetTimeStep(m_timeSteps[index]);
+    bot->SetShouldChange(m_flags[index] & ShouldChangeFlag);
+    bot->SetStream(m_stream);
+}
+
+shared_ptr<Particle> ParticleStore::Get(size_t index) {
+    Sync(index);
+    return m_handles[index];
+}
+
+void ParticleStore::MoveEntry(size_t from, size_t to) {
+    m_handles[to] = std::move(m_handles[from]);
+    m_ids[to] = m_ids[from];
+    m_arcs[to] = m_arcs[from];
+    m_types[to] = m_types[from];
+    m_delays[to] = m_delays[from];
+    m_radii[to] = m_radii[from];
+    m_timeSteps[to] = m_timeSteps[from];
+    m_flags[to] = m_flags[from];
+}
+
+shared_ptr<Particle> ParticleStore::Remove(size_t index) {
+    Sync(index);
+    shared_ptr<Particle> bot = std::move(m_handles[index]);
+    UpdateCounts(m_types[index], m_flags[index] & ActiveFlag, -1);
+    size_t last = m_ids.size() - 1;
+    if (index < last)
+        MoveEntry(last, index);
+    m_handles.pop_back();
+    m_ids.pop_back();
+    m_arcs.pop_back();
+    m_types.pop_back();
+    m_delays.pop_back();
+    m_radii.pop_back();
+    m_timeSteps.pop_back();
+    m_flags.pop_back();
+    return bot;
+}
+
+int ParticleStore::Find(const shared_ptr<Particle> &bot) {
+    for (size_t i = 0; i < m_handles.size(); i++)
+        if (m_handles[i] == bot)
+            return i;
+    return -1;
+}
+
+void ParticleStore::SortByID() {
+    vector<size_t> order(m_ids.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(),
+         [this](size_t a, size_t b) { return m_ids[a] < m_ids[b]; });
+    ParticleStore sorted;
+    sorted.SetStream(m_stream);
+    for (size_t i : order) {
+        sorted.m_handles.push_back(m_handles[i]);
+        sorted.m_ids.push_back(m_ids[i]);
+        sorted.m_arcs.push_back(m_arcs[i]);
+        sorted.m_types.push_back(m_types[i]);
+        sorted.m_delays.push_back(m_delays[i]);
+        sorted.m_radii.push_back(m_radii[i]);
+        sorted.m_timeSteps.push_back(m_timeSteps[i]);
+        sorted.m_flags.push_back(m_flags[i]);
+    }
+    swap(m_handles, sorted.m_handles);
+    swap(m_ids, sorted.m_ids);
+    swap(m_arcs, sorted.m_arcs);
+    swap(m_types, sorted.m_types);
+    swap(m_delays, sorted.m_delays);
+    swap(m_radii, sorted.m_radii);
+    swap(m_timeSteps, sorted.m_timeSteps);
+    swap(m_flags, sorted.m_flags);
+}
+} // namespace bloodcircuit
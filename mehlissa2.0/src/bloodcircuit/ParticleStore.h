@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_PARTICLESTORE_
+#define CLASS_PARTICLESTORE_
+
+#include "../particles/Particle.h"
+#include "../utils/Position.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace particles;
+using namespace utils;
+
+namespace bloodcircuit {
+/**
+ * \brief ParticleCounts counts Particles by ParticleType and the active
+ * CarTCells among them.
+ */
+struct ParticleCounts {
+    size_t types[SwitchableParticleType + 1] = {};
+    size_t total = 0;
+    size_t activeCarTCells = 0;
+};
+
+/**
+ * \brief ParticleStore keeps the Particles of one Bloodstream as a
+ * structure of arrays.
+ *
+ * The fields read by the movement, aging and interaction loops (id, arc
+ * length, type, delay, detection radius, time of the last move and flags) are
+ * stored in parallel arrays, so these loops stream over contiguous memory. The
+ * Particle objects stay reachable through their handles for the per-type
+ * behaviour; the loops check the type column and use As() to reach the
+ * concrete class without RTTI or virtual calls. While a
+ * Particle is in the store, the arrays hold its current arc length, time step
+ * and stream change flag. They are written back to the Particle when it is
+ * handed out via Get(), At() or Remove().
+ *
+ * Particles of a stream move along a straight axis, so their position is kept
+ * as the distance along it. Moving is an addition and leaving the vessel a
+ * comparison with the arc lengths of the vessel ends; the 3D position is only
+ * computed when it is asked for.
+ *
+ * The store counts its Particles by type, and adds the counts to the ones of
+ * its vessel, so populations are known without scanning the streams.
+ */
+class ParticleStore {
+public:
+    enum Flags : uint8_t {
+        CanAgeFlag = 1,       // Particle ages and dies
+        ShouldChangeFlag = 2, // Particle changes its stream in the next change
+        ActiveFlag = 4        // active CarTCell
+    };
+
+private:
+    vector<shared_ptr<Particle>> m_handles;
+    vector<int> m_ids;
+    vector<double> m_arcs;
+    vector<ParticleType> m_types;
+    vector<double> m_delays;
+    vector<double> m_radii; // detection radius
+    vector<uint64_t> m_timeSteps;
+    vector<uint8_t> m_flags;
+    int m_stream; // stream the Particles belong to
+    ParticleCounts m_counts;
+    ParticleCounts *m_vesselCounts; // counts of all streams of the vessel
+    Position m_origin;    // position of arc length 0
+    Position m_direction; // movement per unit of arc length
+    double m_arcMin;      // Particles with a smaller arc length have left
+    double m_arcMax;      // Particles with a larger arc length have left
+
+    // moves the Particle at index from to index to, overwriting to.
+    void MoveEntry(size_t from, size_t to);
+
+    // adds (count = 1) or removes (count = -1) a Particle from the counts
+    void UpdateCounts(ParticleType type, bool active, int count);
+
+public:
+    ParticleStore();
+    ~ParticleStore();
+
+    void SetStream(int stream);
+
+    /// \param counts the counts of the vessel, updated with the ones of the
+    /// store.
+    void SetVesselCounts(ParticleCounts *counts);
+
+    /**
+     * \param origin position of arc length 0, the start of the stream.
+     * \param direction movement per unit of arc length.
+     * \param arcMin smallest arc length inside the vessel.
+     * \param arcMax largest arc length inside the vessel.
+     */
+    void SetAxis(Position origin, Position direction, double arcMin,
+                 double arcMax);
+
+    /// \returns the position at the arc length.
+    Position PositionAt(double arc) {
+        return Position(m_origin.x + arc * m_direction.x,
+                        m_origin.y + arc * m_direction.y,
+                        m_origin.z + arc * m_direction.z);
+    }
+
+    /// \returns the arc length of the point of the axis closest to position.
+    double ArcOf(Position position);
+
+    double GetArcMin() { return m_arcMin; }
+
+    double GetArcMax() { return m_arcMax; }
+
+    /// \returns true if the arc length lies outside of the vessel.
+    bool IsOutside(double arc) { return arc < m_arcMin || arc > m_arcMax; }
+
+    size_t CountType(ParticleType type) { return m_counts.types[type]; }
+
+    size_t CountActiveCarTCells() { return m_counts.activeCarTCells; }
+
+    /// Counts the CarTCell at index as active, called after it killed.
+    void SetActive(size_t index);
+
+    size_t Size() { return m_ids.size(); }
+
+    bool IsEmpty() { return m_ids.size() <= 0; }
+
+    void Clear();
+
+    /// Appends the Particle and captures its hot fields. The Particle is
+    /// placed on the axis, at the arc length closest to its position.
+    void Add(shared_ptr<Particle> bot);
+
+    /// Removes the Particle in O(1), the last Particle moves to index.
+    shared_ptr<Particle> Remove(size_t index);
+
+    /// Writes the hot fields back to the Particle and returns its handle.
+    shared_ptr<Particle> Get(size_t index);
+
+    /// Writes the hot fields back to the Particle and returns it, the store
+    /// keeps the ownership.
+    Particle &At(size_t index) {
+        Sync(index);
+        return *m_handles[index];
+    }
+
+    /// Writes the hot fields of the Particle at index back to the object.
+    void Sync(size_t index);
+
+    /// \returns the index of the Particle or -1 if it is not in the store.
+    int Find(const shared_ptr<Particle> &bot);
+
+    /// Sorts the Particles by their ID.
+    void SortByID();
+
+    // Column access for the hot loops.
+    int GetID(size_t index) { return m_ids[index]; }
+
+    ParticleType GetType(size_t index) { return m_types[index]; }
+
+    double GetDelay(size_t index) { return m_delays[index]; }
+
+    double GetDetectionRadius(size_t index) { return m_radii[index]; }
+
+    Position GetPosition(size_t index) { return PositionAt(m_arcs[index]); }
+
+    double GetArc(size_t index) { return m_arcs[index]; }
+
+    void SetArc(size_t index, double value) { m_arcs[index] = value; }
+
+    /// Moves the Particle at index along the axis.
+    /// \returns true if it has left the vessel.
+    bool Advance(size_t index, double distance) {
+        m_arcs[index] += distance;
+        return IsOutside(m_arcs[index]);
+    }
+
+    uint64_t GetTimeStep(size_t index) { return m_timeSteps[index]; }
+
+    void SetTimeStep(size_t index, uint64_t value) { m_timeSteps[index] = value; }
+
+    bool CanAge(size_t index) { return m_flags[index] & CanAgeFlag; }
+
+    bool GetShouldChange(size_t index) {
+        return m_flags[index] & ShouldChangeFlag;
+    }
+
+    void SetShouldChange(size_t index, bool value) {
+        if (value)
+            m_flags[index] |= ShouldChangeFlag;
+        else
+            m_flags[index] &= ~ShouldChangeFlag;
+    }
+
+    /// Handle without write back, for per-type behaviour that does not read
+    /// the hot fields.
+    const shared_ptr<Particle> &GetHandle(size_t index) {
+        return m_handles[index];
+    }
+
+    /// The Particle at index as its class T, without write back. The caller
+    /// has checked GetType(index), so the cast needs no RTTI.
+    template <typename T> T &As(size_t index) {
+        return static_cast<T &>(*m_handles[index]);
+    }
+};
+}; // namespace bloodcircuit
+#endif
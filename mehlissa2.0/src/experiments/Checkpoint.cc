@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "Checkpoint.h"
+#include <cstring>
+#include <filesystem>
+
+namespace experiments {
+
+// the first bytes of every checkpoint file
+const char CheckpointMagic[] = "MEHLCKP1";
+
+// Reads the magic and the header up to the output offsets.
+static void ReadHeader(istream &in, OutputOffsets &offsets, uint64_t &timeInMS,
+                       uint64_t &step, unsigned int &nextID,
+                       unsigned int &seed) {
+    char magic[8];
+    in.read(magic, 8);
+    if (!in || memcmp(magic, CheckpointMagic, 8) != 0)
+        throw runtime_error("State is no checkpoint");
+    ReadState(in, timeInMS);
+    ReadState(in, step);
+    ReadState(in, nextID);
+    ReadState(in, seed);
+    ReadState(in, offsets);
+}
+
+// Restores the header and the Particles of in into circuit.
+static void RestoreFrom(istream &in, shared_ptr<BloodCircuit> circuit) {
+    OutputOffsets offsets;
+    uint64_t timeInMS, step;
+    unsigned int nextID, seed;
+    ReadHeader(in, offsets, timeInMS, step, nextID, seed);
+    circuit->LoadState(in);
+    // after the state, creating its Particles may have taken IDs
+    GlobalTimer::SetTimer(timeInMS, step);
+    IDCounter::SetNextParticleID(nextID);
+    Randomizer::SetSeed(seed);
+}
+
+Checkpoint::Checkpoint(string file) { m_file = file; }
+
+Checkpoint::~Checkpoint() { WaitForWriter(); }
+
+void Checkpoint::WaitForWriter() {
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
+string Checkpoint::Capture(shared_ptr<BloodCircuit> circuit,
+                           OutputOffsets offsets) {
+    ostringstream state(ios::out | ios::binary);
+    state.write(CheckpointMagic, 8);
+    WriteState(state, GlobalTimer::GetTimeInMS());
+    WriteState(state, GlobalTimer::GetStep());
+    WriteState(state, IDCounter::PeekNextParticleID());
+    WriteState(state, Randomizer::GetSeed());
+    WriteState(state, offsets);
+    circuit->SaveState(state);
+    return state.str();
+}
+
+void Checkpoint::Restore(const string &state,
+                         shared_ptr<BloodCircuit> circuit) {
+    istringstream in(state, ios::in | ios::binary);
+    RestoreFrom(in, circuit);
+}
+
+void Checkpoint::Save(shared_ptr<BloodCircuit> circuit,
+                      OutputOffsets offsets) {
+    // the state is taken between the steps, only the file is written later
+    string state = Capture(circuit, offsets);
+    WaitForWriter();
+    m_writer = thread([file = m_file, data = std::move(state)]() {
+        string temporary = file + ".tmp";
+        {
+            ofstream out(temporary, ios::out | ios::trunc | ios::binary);
+            out.write(data.data(), data.size());
+            if (!out) {
+                cout << "Cannot write checkpoint " << temporary << endl;
+                return;
+            }
+        }
+        // an exception would end the program from the writer thread
+        error_code error;
+        filesystem::rename(temporary, file, error);
+        if (error)
+            cout << "Cannot replace checkpoint " << file << ": "
+                 << error.message() << endl;
+    });
+}
+
+string Checkpoint::GetFormat() { return string(CheckpointMagic, 8); }
+
+OutputOffsets Checkpoint::ReadOutputOffsets(string file) {
+    ifstream in(file, ios::in | ios::binary);
+    if (!in)
+        throw runtime_error("Cannot open checkpoint " + file);
+    OutputOffsets offsets;
+    uint64_t timeInMS, step;
+    unsigned int nextID, seed;
+    ReadHeader(in, offsets, timeInMS, step, nextID, seed);
+    return offsets;
+}
+
+void Checkpoint::Load(string file, shared_ptr<BloodCircuit> circuit) {
+    ifstream in(file, ios::in | ios::binary);
+    if (!in)
+        throw runtime_error("Cannot open checkpoint " + file);
+    RestoreFrom(in, circuit);
+}
+} // namespace experiments
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_CHECKPOINT_
+#define CLASS_CHECKPOINT_
+
+#include "../bloodcircuit/BloodCircuit.h"
+#include "../utils/GlobalTimer.h"
+#include "../utils/IDCounter.h"
+#include "../utils/Printer.h"
+#include "../utils/Randomizer.h"
+#include "../utils/StateIO.h"
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace bloodcircuit;
+using namespace utils;
+
+namespace experiments {
+/**
+ * \brief Checkpoint writes the state of a running simulation to a file and
+ * restores it, so long runs can be continued after they stopped.
+ *
+ * A checkpoint holds the timer, the next Particle ID, the seed, the sizes of
+ * the output files and the Particles of all vessels. The randomness is keyed
+ * by step, vessel and Particle ID, so a resumed simulation draws the same
+ * values and writes the same output as an uninterrupted one.
+ *
+ * The state is serialized into memory between two steps, the file is written
+ * on a background thread while the simulation continues. It is written to a
+ * temporary file first and renamed, so a crash while writing keeps the
+ * previous checkpoint.
+ *
+ * Capture() and Restore() keep the same state in memory, e.g. to simulate
+ * several branches from one shared prefix.
+ */
+class Checkpoint {
+private:
+    string m_file;
+    thread m_writer; // writes the last saved checkpoint
+
+    // Waits until the last checkpoint is written.
+    void WaitForWriter();
+
+public:
+    /// \param file the checkpoint file, replaced by every Save().
+    Checkpoint(string file);
+
+    /// Waits until the last checkpoint is written.
+    ~Checkpoint();
+
+    /**
+     * Saves the state of circuit after the current step.
+     * \param offsets the sizes of the output files after the step.
+     */
+    void Save(shared_ptr<BloodCircuit> circuit, OutputOffsets offsets);
+
+    /// \returns the state of circuit after the current step, in the format
+    /// of the checkpoint file.
+    static string Capture(shared_ptr<BloodCircuit> circuit,
+                          OutputOffsets offsets);
+
+    /// Restores a state returned by Capture(), see Load().
+    static void Restore(const string &state, shared_ptr<BloodCircuit> circuit);
+
+    /// \returns the tag of the checkpoint format, which changes with the
+    /// layout of the state.
+    static string GetFormat();
+
+    /// \returns the sizes of the output files stored in file.
+    static OutputOffsets ReadOutputOffsets(string file);
+
+    /**
+     * Restores the timer, the IDs, the seed and the Particles of file into
+     * circuit, which must be built from the same vasculature.
+     */
+    static void Load(string file, shared_ptr<BloodCircuit> circuit);
+};
+}; // namespace experiments
+#endif
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "EventDrivenEngine.h"
+
+namespace experiments {
+
+EventDrivenEngine::EventDrivenEngine(shared_ptr<BloodCircuit> circuit) {
+    m_circuit = circuit;
+    m_lastStep = 0;
+    m_processedEvents = 0;
+}
+
+string EventDrivenEngine::FindUnsupported(shared_ptr<BloodCircuit> circuit,
+                                          double timeStep,
+                                          uint64_t numberOfSeconds) {
+    // Particles move once per second, a step has to be one second
+    if (timeStep != 1)
+        return "the simulationStep is not 1";
+    if (Printer::outputFormat != EventFormat &&
+        Printer::outputFormat != NoOutputFormat)
+        return "the output format prints positions in every step";
+    for (auto &entry : circuit->GetBloodCircuit()) {
+        shared_ptr<BloodVessel> vessel = entry.second;
+        if (vessel->HasInjectionUntil(numberOfSeconds))
+            return "CAR-T cells are injected into vessel " +
+                   to_string(entry.first);
+        for (int i = 0; i < vessel->GetNumberOfStreams(); i++) {
+            ParticleStore &store = vessel->GetStream(i)->GetParticleStore();
+            for (size_t j = 0; j < store.Size(); j++) {
+                ParticleType type = store.GetType(j);
+                if (type != BaseParticleType && type != CancerCellType &&
+                    type != TCellType)
+                    return "particles of type " + to_string(type) +
+                           " interact";
+                if (store.CanAge(j))
+                    return "particles age";
+            }
+        }
+    }
+    return "";
+}
+
+int EventDrivenEngine::Simulate(uint64_t numberOfSeconds) {
+    m_lastStep = numberOfSeconds;
+    for (auto &entry : m_circuit->GetBloodCircuit()) {
+        shared_ptr<BloodVessel> vessel = entry.second;
+        if (vessel->ReportsGateway())
+            m_gateways.push_back(vessel);
+        for (int i = 0; i < vessel->GetNumberOfStreams(); i++) {
+            ParticleStore &store = vessel->GetStream(i)->GetParticleStore();
+            for (size_t j = 0; j < store.Size(); j++)
+                m_particles[store.GetID(j)] = {vessel, i, j};
+        }
+    }
+    uint64_t step = GlobalTimer::GetStep();
+    for (auto &particle : m_particles)
+        Predict(particle.first, particle.second, step, true);
+
+    while (GlobalTimer::NowInSeconds() <= numberOfSeconds) {
+        cout << GlobalTimer::NowInSeconds() << "s" << endl;
+        step = GlobalTimer::GetStep();
+        // the steps count the cells before any of them moves
+        for (const shared_ptr<BloodVessel> &vessel : m_gateways)
+            vessel->PrintGatewayCounts();
+        while (!m_queue.empty() && m_queue.top().step == step) {
+            PredictedEvent event = m_queue.top();
+            m_queue.pop();
+            Process(event);
+        }
+        m_circuit->FinishStep();
+        GlobalTimer::IncreaseTimer(1);
+    }
+    WriteFinalStates();
+    cout << "Processed " << m_processedEvents << " events of "
+         << m_particles.size() << " particles." << endl;
+    return GlobalTimer::NowInSeconds();
+}
+
+void EventDrivenEngine::Predict(int particleID,
+                                const TrackedParticle &particle,
+                                uint64_t step, bool changeStreams) {
+    ParticleStore &store =
+        particle.vessel->GetStream(particle.stream)->GetParticleStore();
+    double arc = store.GetArc(particle.index);
+    uint64_t timeStep = store.GetTimeStep(particle.index);
+    double delay = store.GetDelay(particle.index);
+    for (; step <= m_lastStep; step++, changeStreams = true) {
+        if (changeStreams) {
+            int stream = particle.vessel->StreamChangeTarget(
+                particleID, particle.stream, step);
+            if (stream >= 0) {
+                m_queue.push({step, particleID, stream, arc, timeStep});
+                return;
+            }
+        }
+        // with steps of one second the step is the time in seconds
+        if (timeStep < step) {
+            timeStep = step;
+            if (particle.vessel->PredictMovement(particleID, particle.stream,
+                                                 delay, step, arc)) {
+                m_queue.push({step, particleID, -1, arc, timeStep});
+                return;
+            }
+        }
+    }
+    // no event until the end, the movement is already summed up
+    m_finalStates[particleID] = {arc, timeStep};
+}
+
+void EventDrivenEngine::WriteFinalStates() {
+    for (auto &entry : m_finalStates) {
+        const TrackedParticle &particle = m_particles[entry.first];
+        ParticleStore &store =
+            particle.vessel->GetStream(particle.stream)->GetParticleStore();
+        store.SetArc(particle.index, entry.second.arc);
+        store.SetTimeStep(particle.index, entry.second.timeStep);
+    }
+    m_finalStates.clear();
+}
+
+void EventDrivenEngine::Removed(ParticleStore &store, size_t index) {
+    if (index < store.Size())
+        m_particles[store.GetID(index)].index = index;
+}
+
+void EventDrivenEngine::Process(const PredictedEvent &event) {
+    m_processedEvents++;
+    TrackedParticle &particle = m_particles[event.particleID];
+    shared_ptr<BloodVessel> vessel = particle.vessel;
+    ParticleStore &store =
+        vessel->GetStream(particle.stream)->GetParticleStore();
+    store.SetArc(particle.index, event.arc);
+    store.SetTimeStep(particle.index, event.timeStep);
+
+    if (event.stream >= 0) {
+        vessel->ChangeParticleStream(particle.stream, particle.index,
+                                     event.stream);
+        Removed(store, particle.index);
+        particle.stream = event.stream;
+        particle.index =
+            vessel->GetStream(event.stream)->GetParticleStore().Size() - 1;
+        // the Particle still moves in this step
+        Predict(event.particleID, particle, event.step, false);
+        return;
+    }
+
+    shared_ptr<Particle> bot = vessel->DepartParticle(particle.stream,
+                                                      particle.index);
+    Removed(store, particle.index);
+    shared_ptr<BloodVessel> next = vessel->RouteDeparture(*bot,
+                                                          particle.stream);
+    next->EnterParticle(particle.stream, std::move(bot));
+    particle.vessel = next;
+    particle.index =
+        next->GetStream(particle.stream)->GetParticleStore().Size() - 1;
+    Predict(event.particleID, particle, event.step + 1, true);
+}
+} // namespace experiments
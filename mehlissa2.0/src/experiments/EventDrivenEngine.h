@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_EVENTDRIVENENGINE_
+#define CLASS_EVENTDRIVENENGINE_
+
+#include "../bloodcircuit/BloodCircuit.h"
+#include "../bloodcircuit/BloodVessel.h"
+#include "../utils/GlobalTimer.h"
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace bloodcircuit;
+using namespace utils;
+
+namespace experiments {
+/**
+ * \brief EventDrivenEngine simulates a BloodCircuit by jumping every Particle
+ * from one stream change or vessel exit to the next instead of moving all
+ * Particles in every step.
+ *
+ * The movement of a Particle only depends on its own keyed random values
+ * (KeyedRandom), as long as it does not interact with other Particles. So the
+ * step of its next stream change or exit is predicted by summing its step
+ * distances, without touching any other Particle. The predictions wait in a
+ * global priority queue ordered by step and particle ID. Only the Particles
+ * whose prediction is due are updated, the others keep the arc length of their
+ * last event in their ParticleStore until Simulate() returns and writes their
+ * final arc lengths back. The printed events, the gateway counts and the
+ * state at the end equal the ones of the stepped simulation.
+ *
+ * Interactions, aging, injections and outputs with positions in every step
+ * need all Particles in every step, see FindUnsupported().
+ */
+class EventDrivenEngine {
+private:
+    // The vessel, stream and store index of a Particle
+    struct TrackedParticle {
+        shared_ptr<BloodVessel> vessel;
+        int stream;
+        size_t index;
+    };
+
+    // The next stream change or exit of a Particle
+    struct PredictedEvent {
+        uint64_t step;
+        int particleID;
+        int stream;        // stream to change to, -1 for an exit
+        double arc;        // arc length right before the event
+        uint64_t timeStep; // second of the last movement before the event
+    };
+
+    // Where the prediction of a Particle without further events ended
+    struct FinalState {
+        double arc;
+        uint64_t timeStep;
+    };
+
+    struct Later {
+        bool operator()(const PredictedEvent &a, const PredictedEvent &b) {
+            if (a.step != b.step)
+                return a.step > b.step;
+            return a.particleID > b.particleID;
+        }
+    };
+
+    shared_ptr<BloodCircuit> m_circuit;
+    vector<shared_ptr<BloodVessel>> m_gateways; // vessels printing counts
+    unordered_map<int, TrackedParticle> m_particles;
+    priority_queue<PredictedEvent, vector<PredictedEvent>, Later> m_queue;
+    unordered_map<int, FinalState> m_finalStates;
+    uint64_t m_lastStep; // events after this step are not predicted
+    size_t m_processedEvents;
+
+    // Predicts the next event of the Particle, starting in step. If
+    // changeStreams is false, the stream change of step is already done.
+    void Predict(int particleID, const TrackedParticle &particle,
+                 uint64_t step, bool changeStreams);
+
+    void Process(const PredictedEvent &event);
+
+    // Updates the index of the Particle that took over index after a removal
+    // from store.
+    void Removed(ParticleStore &store, size_t index);
+
+    // Writes the final states to the stores, so the circuit is in the state
+    // of the stepped simulation at the last simulated step.
+    void WriteFinalStates();
+
+public:
+    EventDrivenEngine(shared_ptr<BloodCircuit> circuit);
+
+    /**
+     * \returns why the circuit cannot be simulated event-driven with the
+     * given step length, or an empty string if it can.
+     */
+    static string FindUnsupported(shared_ptr<BloodCircuit> circuit,
+                                  double timeStep, uint64_t numberOfSeconds);
+
+    /**
+     * Simulates up to numberOfSeconds in steps of one second. Afterwards all
+     * Particles are at their positions of the last step, so the simulation
+     * can go on step by step.
+     * \returns the simulated time in seconds.
+     */
+    int Simulate(uint64_t numberOfSeconds);
+
+    /// \returns the number of stream changes and exits processed.
+    size_t GetProcessedEvents() { return m_processedEvents; }
+};
+}; // namespace experiments
+#endif
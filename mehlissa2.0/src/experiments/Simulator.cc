@@ -24,6 +24,11 @@ namespace experiments {
 Simulator::Simulator(int parallelity, double timeStep, shared_ptr<BloodCircuit> circuit){
     this->m_parallelity = parallelity;
     this->m_timeStep = timeStep;
+    this->m_eventDriven = false;
+    this->m_transitTimeStep = 0;
+    this->m_checkpointEveryMS = 0;
+    this->m_nextCheckpointMS = 0;
+    this->m_scheduler = make_shared<WorkStealingScheduler>(parallelity);
     GlobalTimer::ResetTimer();
     
     this->m_circuit = circuit;
@@ -43,12 +48,169 @@ Simulator::~Simulator() {
 }
 
 int Simulator::Simulate(uint64_t numberOfSeconds) {
-    if (m_parallelity > 1)
-        cout << "No parallel execution implemented, yet! Simulating sequentially." << endl;
-    SimulateSequential(numberOfSeconds);
+    SimulateUntil(numberOfSeconds);
+    for (const shared_ptr<StatisticsStage> &stage : m_statisticsStages)
+        stage->Finish();
     return GlobalTimer::NowInSeconds();
 }
 
+int Simulator::SimulateUntil(uint64_t numberOfSeconds) {
+    if (m_transitTimeStep > 0) {
+        string reason = TransitTimeEngine::FindUnsupported();
+        if (!m_statisticsStages.empty())
+            reason = "statistics are collected";
+        if (m_checkpoint != nullptr)
+            reason = "checkpoints are saved";
+        if (reason == "") {
+            TransitTimeEngine engine(m_circuit, m_transitTimeStep);
+            return engine.Simulate(numberOfSeconds);
+        }
+        cout << "Cannot simulate transit times, " << reason
+             << ". Simulating step by step." << endl;
+    }
+    if (m_eventDriven) {
+        string reason = EventDrivenEngine::FindUnsupported(
+            m_circuit, m_timeStep, numberOfSeconds);
+        // the stages observe all particles in every step
+        if (!m_statisticsStages.empty())
+            reason = "statistics are collected";
+        // the engine keeps Particles between their events
+        if (m_checkpoint != nullptr)
+            reason = "checkpoints are saved";
+        if (reason == "") {
+            EventDrivenEngine engine(m_circuit);
+            return engine.Simulate(numberOfSeconds);
+        }
+        cout << "Cannot simulate event-driven, " << reason
+             << ". Simulating step by step." << endl;
+    }
+    if (m_parallelity > 1)
+        return SimulateParallel(numberOfSeconds);
+    return SimulateSequential(numberOfSeconds);
+}
+
+void Simulator::AddStatisticsStage(shared_ptr<StatisticsStage> stage) {
+    m_statisticsStages.push_back(stage);
+}
+
+void Simulator::SetEventDriven(bool value) { m_eventDriven = value; }
+
+void Simulator::SetTransitTimeStep(int seconds) { m_transitTimeStep = seconds; }
+
+void Simulator::SetCheckpoints(string file, int seconds) {
+    if (seconds <= 0)
+        throw runtime_error("Checkpoints need a positive interval");
+    m_checkpoint = make_shared<Checkpoint>(file);
+    m_checkpointEveryMS = (uint64_t)seconds * 1000;
+    m_nextCheckpointMS = GlobalTimer::GetTimeInMS() + m_checkpointEveryMS;
+}
+
+void Simulator::Resume(string file) {
+    Checkpoint::Load(file, m_circuit);
+    cout << "Resuming at " << GlobalTimer::NowInSeconds() << "s" << endl;
+    m_nextCheckpointMS = GlobalTimer::GetTimeInMS() + m_checkpointEveryMS;
+}
+
+void Simulator::SimulateBranches(uint64_t forkTime, uint64_t numberOfSeconds,
+                                 const vector<Branch> &branches) {
+    if (!m_statisticsStages.empty() || m_checkpoint != nullptr)
+        throw runtime_error("Branches cannot collect statistics or save "
+                            "checkpoints");
+    // the passages of the coarse steps live in the engine, the captured
+    // state cannot continue them
+    if (m_transitTimeStep > 0)
+        throw runtime_error("Branches cannot be used with a "
+                            "transitTimeStep");
+    for (const Branch &branch : branches)
+        if (branch.injectionTime < forkTime)
+            throw runtime_error("A branch injects at " +
+                                to_string(branch.injectionTime) +
+                                "s, before the fork at " +
+                                to_string(forkTime) + "s");
+    // the prefix ends with the timer at forkTime
+    if (forkTime > 0)
+        SimulateUntil(forkTime - 1);
+    shared_ptr<Printer> prefix = m_circuit->GetPrinter();
+    OutputOffsets offsets = m_circuit->FlushOutput();
+    string state = Checkpoint::Capture(m_circuit, offsets);
+    for (size_t k = 0; k < branches.size(); k++) {
+        const Branch &branch = branches[k];
+        Checkpoint::Restore(state, m_circuit);
+        cout << "Branch " << k + 1 << " of " << branches.size()
+             << " from " << GlobalTimer::NowInSeconds() << "s" << endl;
+        Randomizer::SetSeed(branch.seed);
+        m_circuit->SetCarTCellInjection(branch.numCarTCells,
+                                        branch.injectionVessel,
+                                        branch.injectionTime);
+        m_circuit->SetPrinter(
+            prefix->Fork(branch.simFile, branch.gwFile, offsets));
+        Simulate(numberOfSeconds);
+    }
+}
+
+int Simulator::SimulateWithWarmup(shared_ptr<WarmupCache> cache,
+                                  uint64_t warmupTime,
+                                  uint64_t numberOfSeconds) {
+    // the passages of the coarse steps live in the engine, a saved state
+    // cannot continue them
+    if (m_transitTimeStep > 0)
+        throw runtime_error("The warm-up cache cannot be used with a "
+                            "transitTimeStep");
+    // joined at the end, the state is written while the simulation goes on
+    Checkpoint warmup(cache->GetFile());
+    if (cache->HasState()) {
+        // the cached state was saved with the injections of its run
+        map<int, CarTCell::CarTCellInjection> injections =
+            m_circuit->GetCarTCellInjections();
+        Checkpoint::Load(cache->GetFile(), m_circuit);
+        m_circuit->SetCarTCellInjections(injections);
+        m_nextCheckpointMS = GlobalTimer::GetTimeInMS() + m_checkpointEveryMS;
+        cout << "Starting from the warm-up state " << cache->GetFile()
+             << " at " << GlobalTimer::NowInSeconds() << "s" << endl;
+    } else {
+        // the warm-up ends with the timer at warmupTime
+        if (warmupTime > 0)
+            SimulateUntil(warmupTime - 1);
+        warmup.Save(m_circuit, OutputOffsets());
+    }
+    return Simulate(numberOfSeconds);
+}
+
+vector<Branch> Simulator::ParseBranches(string branches) {
+    vector<Branch> parsed;
+    stringstream list(branches);
+    string entry;
+    while (getline(list, entry, ',')) {
+        if (entry == "")
+            continue;
+        Branch branch;
+        char separator1, separator2;
+        stringstream fields(entry);
+        fields >> branch.injectionTime >> separator1 >>
+            branch.injectionVessel >> separator2 >> branch.numCarTCells;
+        if (!fields || separator1 != ':' || separator2 != ':')
+            throw runtime_error("Cannot parse the branch " + entry);
+        branch.seed = 0;
+        parsed.push_back(branch);
+    }
+    return parsed;
+}
+
+string Simulator::BranchFile(string file, int branch) {
+    filesystem::path path(file);
+    string name = path.stem().string() + ".branch" + to_string(branch) +
+                  path.extension().string();
+    return path.replace_filename(name).string();
+}
+
+void Simulator::SaveCheckpointIfDue() {
+    if (m_checkpoint == nullptr ||
+        GlobalTimer::GetTimeInMS() < m_nextCheckpointMS)
+        return;
+    m_checkpoint->Save(m_circuit, m_circuit->FlushOutput());
+    m_nextCheckpointMS += m_checkpointEveryMS;
+}
+
 int Simulator::SimulateSequential(uint64_t numberOfSeconds) {
     while(m_nextSteps.size() > 0 && GlobalTimer::NowInSeconds() <= numberOfSeconds) {
         cout << GlobalTimer::NowInSeconds() << "s" << endl;
@@ -65,28 +227,111 @@ int Simulator::SimulateSequential(uint64_t numberOfSeconds) {
             // if (bv_next != nullptr)
                 // m_nextSteps.push_back(bv_next);
             m_nextSteps.push_back(bv);
-            if (bv->NeedsTransferStep())
-                m_transferStepsSafeAppendRange({bv});
         }
+        AddBirths();
         // cout << "do transfer" << endl;
         inbetween = clock();
 
-        while (m_transferSteps.size() > 0) {
-            //cout << "t";
-            shared_ptr<BloodVessel> ts = m_transferStepsSafePop();
-            //cout << ts->GetbloodvesselID() << endl;
-            ts->PerformTransferStep();
-        }
+        TransferParticles();
+        ObserveStep();
 
         finish = clock();
         // cout << "first part: " << (inbetween - start)/CLOCKS_PER_SEC
         //      << "    second part: " << (finish - inbetween)/CLOCKS_PER_SEC
         //      << endl;
+        m_circuit->FinishStep();
+        GlobalTimer::IncreaseTimer(m_timeStep);
+        SaveCheckpointIfDue();
+    }
+    return GlobalTimer::NowInSeconds();
+}
+
+int Simulator::SimulateParallel(uint64_t numberOfSeconds) {
+    cout << "Simulating in parallel with " << m_parallelity << " threads."
+         << endl;
+    while(m_nextSteps.size() > 0 && GlobalTimer::NowInSeconds() <= numberOfSeconds) {
+        cout << GlobalTimer::NowInSeconds() << "s" << endl;
+        uint64_t now = GlobalTimer::NowInSeconds();
+
+        // Every vessel only touches its own streams during Step(), so the
+        // vessels can be stepped concurrently. Shared utilities (Randomizer,
+        // IDCounter, Printer) are thread safe. The particle count left by the
+        // previous step estimates the cost of each vessel.
+        ForEachVessel(
+            m_nextSteps,
+            [](shared_ptr<BloodVessel> bv) { return bv->CountParticles(); },
+            [now](shared_ptr<BloodVessel> bv) { bv->Step(now); });
+        cout << "  load imbalance: " << m_scheduler->GetImbalance()
+             << ", steals: " << m_scheduler->GetSteals()
+             << ", max/total particles per thread: "
+             << m_scheduler->GetMaxProcessedLoad() << "/"
+             << m_scheduler->GetTotalLoad() << endl;
+        AddBirths();
+
+        TransferParticles();
+        ObserveStep();
+        m_circuit->FinishStep();
         GlobalTimer::IncreaseTimer(m_timeStep);
+        SaveCheckpointIfDue();
     }
     return GlobalTimer::NowInSeconds();
 }
 
+void Simulator::ForEachVessel(const list<shared_ptr<BloodVessel>> &vessels,
+                              function<size_t(shared_ptr<BloodVessel>)> weight,
+                              function<void(shared_ptr<BloodVessel>)> task) {
+    if (m_parallelity > 1) {
+        // the output is added in vessel order, like in the loop below
+        shared_ptr<Printer> printer = m_circuit->GetPrinter();
+        printer->BeginVesselOrder();
+        m_scheduler->Run(vessels, weight, task);
+        printer->EndVesselOrder();
+        return;
+    }
+    for (const shared_ptr<BloodVessel> &bv : vessels)
+        task(bv);
+}
+
+void Simulator::AddBirths() {
+    // m_nextSteps is in ascending ID order, so are the new IDs
+    for (auto bv : m_nextSteps)
+        bv->AddBirths();
+}
+
+void Simulator::ObserveStep() {
+    if (m_statisticsStages.empty())
+        return;
+    map<int, shared_ptr<BloodVessel>> vessels = m_circuit->GetBloodCircuit();
+    for (const shared_ptr<StatisticsStage> &stage : m_statisticsStages)
+        stage->ObserveStep(vessels, GlobalTimer::NowInSeconds());
+}
+
+void Simulator::TransferParticles() {
+    // Collect the sending vessels in ascending ID order, this order decides
+    // the order in which the receiving vessels add the particles.
+    for (auto bv : m_nextSteps)
+        if (bv->NeedsTransferStep())
+            m_transferStepsSafePushBack(bv);
+    list<shared_ptr<BloodVessel>> senders = m_transferSteps;
+    m_transferStepsSafeClear();
+    if (senders.size() == 0)
+        return;
+
+    // Phase one: every sender only writes into its own inboxes.
+    ForEachVessel(
+        senders,
+        [](shared_ptr<BloodVessel> bv) { return bv->CountDepartingParticles(); },
+        [](shared_ptr<BloodVessel> bv) { bv->PerformTransferStep(); });
+
+    // Phase two: every vessel only adds to its own streams.
+    ForEachVessel(
+        m_nextSteps,
+        [](shared_ptr<BloodVessel>) { return 1; },
+        [&senders](shared_ptr<BloodVessel> bv) { bv->ReceiveTransfers(senders); });
+    for (auto bv : senders)
+        bv->ClearInboxes();
+}
+
 void Simulator::m_nextStepsSafeClear()
 {
     const std::lock_guard<std::mutex> lock(m_nextSteps_mutex);
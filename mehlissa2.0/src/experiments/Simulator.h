@@ -23,9 +23,17 @@
 #include "../bloodcircuit/BloodVessel.h"
 #include "../bloodcircuit/BloodCircuit.h"
 #include "../utils/GlobalTimer.h"
+#include "Checkpoint.h"
+#include "EventDrivenEngine.h"
+#include "StatisticsStage.h"
+#include "TransitTimeEngine.h"
+#include "WarmupCache.h"
+#include "WorkStealingScheduler.h"
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <random>
+#include <sstream>
 #include <stdexcept>
 #include <list>
 #include <memory>
@@ -37,6 +45,17 @@ using namespace bloodcircuit;
 using namespace utils;
 
 namespace experiments {
+// A variant of the CarTCell injection, simulated from the state shared by
+// all branches, see Simulator::SimulateBranches().
+struct Branch {
+    unsigned int injectionTime;
+    unsigned int injectionVessel;
+    unsigned int numCarTCells;
+    unsigned int seed; // of the random values after the fork
+    string simFile;
+    string gwFile;
+};
+
 class Simulator {
 private:
 
@@ -48,7 +67,14 @@ private:
     list<shared_ptr<BloodVessel>> m_transferSteps;
     list<shared_ptr<BloodVessel>> m_nextSteps;
     int m_parallelity;
+    shared_ptr<WorkStealingScheduler> m_scheduler;
     double m_timeStep; // in seconds
+    vector<shared_ptr<StatisticsStage>> m_statisticsStages;
+    bool m_eventDriven; // jump Particles to their next event if possible
+    int m_transitTimeStep; // seconds between coarse steps, 0 for off
+    shared_ptr<Checkpoint> m_checkpoint; // nullptr for no checkpoints
+    uint64_t m_checkpointEveryMS;
+    uint64_t m_nextCheckpointMS;
 
     void m_nextStepsSafeClear();
 
@@ -74,7 +100,34 @@ private:
     
     shared_ptr<BloodVessel> m_currentStepsSafePop();
     
+    // Simulates with the engine chosen by the settings, without finishing
+    // the statistics stages.
+    int SimulateUntil(uint64_t numberOfSeconds);
+
     int SimulateSequential(uint64_t numberOfSeconds);
+
+    // Steps the vessels concurrently on m_parallelity OpenMP threads.
+    int SimulateParallel(uint64_t numberOfSeconds);
+
+    // Runs task for all vessels, on the scheduler if running in parallel and
+    // in the given order otherwise. The vessels are in ascending ID order, so
+    // the Printer gets their output in the same order in both cases.
+    void ForEachVessel(const list<shared_ptr<BloodVessel>> &vessels,
+                       function<size_t(shared_ptr<BloodVessel>)> weight,
+                       function<void(shared_ptr<BloodVessel>)> task);
+
+    // Adds the cells created during the step, vessel by vessel in ID order.
+    void AddBirths();
+
+    // Moves the particles that left their vessels in two phases: senders fill
+    // their inboxes, then receivers merge them in ascending sender ID order.
+    void TransferParticles();
+
+    // Lets the statistics stages observe the vessels after the step.
+    void ObserveStep();
+
+    // Saves a checkpoint after the step if one is due.
+    void SaveCheckpointIfDue();
     
 public:
     Simulator(int parallelity, double timeStep, shared_ptr<BloodCircuit> circuit);
@@ -82,6 +135,54 @@ public:
     ~Simulator();
 
     int Simulate(uint64_t numberOfSeconds);
+
+    /// Adds a stage that observes every step of the simulation.
+    void AddStatisticsStage(shared_ptr<StatisticsStage> stage);
+
+    /// Simulates with the EventDrivenEngine if the circuit allows it, and
+    /// step by step otherwise.
+    void SetEventDriven(bool value);
+
+    /// Simulates with the TransitTimeEngine and interactions every seconds
+    /// if seconds > 0. It takes precedence over SetEventDriven().
+    void SetTransitTimeStep(int seconds);
+
+    /// Saves a Checkpoint to file every seconds of simulated time while
+    /// simulating step by step.
+    void SetCheckpoints(string file, int seconds);
+
+    /// Continues the simulation saved in the Checkpoint file.
+    void Resume(string file);
+
+    /**
+     * Simulates until forkTime once, then every branch from that state until
+     * numberOfSeconds. The state at forkTime is kept in memory and restored
+     * before each branch. A branch writes its own files, which start with a
+     * copy of the output until forkTime.
+     * Throws with a transit time step.
+     * \param forkTime at most the injection time of every branch.
+     */
+    void SimulateBranches(uint64_t forkTime, uint64_t numberOfSeconds,
+                          const vector<Branch> &branches);
+
+    /**
+     * \param branches comma separated injectionTime:injectionVessel:
+     * numCarTCells, e.g. "40:29:100,60:29:200".
+     * \returns the branches without seeds and files.
+     */
+    static vector<Branch> ParseBranches(string branches);
+
+    /**
+     * Simulates until numberOfSeconds. If cache holds a state, the
+     * simulation starts from it at warmupTime, with the pending CarTCell
+     * injections of the circuit. Otherwise the state at warmupTime is added
+     * to cache. Throws with a transit time step.
+     */
+    int SimulateWithWarmup(shared_ptr<WarmupCache> cache, uint64_t warmupTime,
+                           uint64_t numberOfSeconds);
+
+    /// \returns the file of branch, e.g. "out.branch2.csv" for "out.csv".
+    static string BranchFile(string file, int branch);
 };
 }; // namespace experiments
 #endif
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_STATISTICSSTAGE_
+#define CLASS_STATISTICSSTAGE_
+
+#include "../bloodcircuit/BloodVessel.h"
+#include <map>
+#include <memory>
+#include <ostream>
+
+using namespace std;
+using namespace bloodcircuit;
+
+namespace experiments {
+/**
+ * \brief A StatisticsStage summarises the simulation while it runs, instead
+ * of evaluating the particle output afterwards. The Simulator calls
+ * ObserveStep() once per step, when the transfers of the step are done.
+ */
+class StatisticsStage {
+public:
+    virtual ~StatisticsStage() {}
+
+    /**
+     * \param vessels all vessels by ID, with the Particles after the step.
+     * \param time the simulation time of the step in seconds.
+     */
+    virtual void ObserveStep(const map<int, shared_ptr<BloodVessel>> &vessels,
+                             double time) = 0;
+
+    /// Called once after the last step.
+    virtual void Finish() = 0;
+
+    virtual void WriteSummary(ostream &output) = 0;
+};
+}; // namespace experiments
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "TransitStatistics.h"
+#include <cmath>
+
+namespace experiments {
+
+// histograms of the dwell times and of the times between gateway arrivals
+const double DwellBinWidth = 1;
+const size_t DwellBins = 60;
+const double ArrivalBinWidth = 5;
+const size_t ArrivalBins = 120;
+
+Distribution::Distribution(double binWidth, size_t numberOfBins)
+    : histogram(binWidth, numberOfBins), median(0.5), p90(0.9) {}
+
+void Distribution::Add(double value) {
+    moments.Add(value);
+    histogram.Add(value);
+    median.Add(value);
+    p90.Add(value);
+}
+
+TransitStatistics::TransitStatistics() { m_steps = 0; }
+
+void TransitStatistics::ObserveStep(
+    const map<int, shared_ptr<BloodVessel>> &vessels, double time) {
+    m_steps++;
+    map<int, vector<size_t>> occupancy;
+    for (const auto &v : vessels) {
+        shared_ptr<BloodVessel> vessel = v.second;
+        bool gateway = vessel->IsGatewayVessel();
+        vector<size_t> &counts = occupancy[v.first];
+        counts.resize(SwitchableParticleType + 1, 0);
+        for (int i = 0; i < vessel->GetNumberOfStreams(); i++) {
+            ParticleStore &store = vessel->GetStream(i)->GetParticleStore();
+            for (size_t j = 0; j < store.Size(); j++) {
+                ParticleType type = store.GetType(j);
+                counts[type]++;
+                auto track = m_tracks.try_emplace(store.GetID(j));
+                if (track.second) {
+                    m_types.insert(type);
+                    // only vessels entered while observed have a dwell time
+                    track.first->second = {v.first, type, time, time,
+                                           gateway ? time : -1, m_steps > 1,
+                                           0, 0};
+                } else {
+                    ObserveParticle(track.first->second, v.first, gateway,
+                                    time);
+                }
+                track.first->second.lastSeen = m_steps;
+                if (type == NanoparticleType)
+                    track.first->second.detections =
+                        store.GetHandle(j)->GotDetected();
+            }
+        }
+    }
+    // vessels without Particles of a type count as empty
+    for (auto &counts : occupancy)
+        for (int type : m_types)
+            m_occupancy[{counts.first, type}].Add(counts.second[type]);
+    // Particles that are gone died during the step
+    for (auto track = m_tracks.begin(); track != m_tracks.end();) {
+        if (track->second.lastSeen != m_steps) {
+            EndTrack(track->second);
+            track = m_tracks.erase(track);
+        } else {
+            track++;
+        }
+    }
+}
+
+void TransitStatistics::ObserveParticle(ParticleTrack &track, int vesselID,
+                                        bool gateway, double time) {
+    if (track.vesselID == vesselID)
+        return;
+    if (track.entryObserved)
+        m_dwellTimes
+            .try_emplace({track.vesselID, track.type}, DwellBinWidth,
+                         DwellBins)
+            .first->second.Add(time - track.entryTime);
+    track.vesselID = vesselID;
+    track.entryTime = time;
+    track.entryObserved = true;
+    if (!gateway)
+        return;
+    if (track.gatewayTime < 0)
+        m_firstArrivalTimes
+            .try_emplace(track.type, ArrivalBinWidth, ArrivalBins)
+            .first->second.Add(time - track.birthTime);
+    else
+        m_circulationTimes
+            .try_emplace(track.type, ArrivalBinWidth, ArrivalBins)
+            .first->second.Add(time - track.gatewayTime);
+    track.gatewayTime = time;
+}
+
+void TransitStatistics::EndTrack(const ParticleTrack &track) {
+    if (track.type == NanoparticleType)
+        m_detections[track.type].Add(track.detections);
+}
+
+void TransitStatistics::Finish() {
+    for (auto &track : m_tracks)
+        EndTrack(track.second);
+    m_tracks.clear();
+}
+
+static void WriteMoments(ostream &output, string statistic, int vesselID,
+                         int type, RunningMoments &moments) {
+    output << statistic << "," << vesselID << "," << type << ","
+           << moments.GetCount() << "," << moments.GetMean() << ","
+           << sqrt(moments.GetVariance()) << "," << moments.GetMin() << ","
+           << moments.GetMax();
+}
+
+static void WriteDistribution(ostream &output, string statistic, int vesselID,
+                              int type, Distribution &distribution) {
+    WriteMoments(output, statistic, vesselID, type, distribution.moments);
+    output << "," << distribution.median.Get() << ","
+           << distribution.p90.Get() << "\n";
+}
+
+static void WriteHistogram(ostream &output, string statistic, int vesselID,
+                           int type, Histogram &histogram) {
+    output << "histogram," << statistic << "," << vesselID << "," << type
+           << "," << histogram.GetBinWidth() << "," << histogram.GetOverflow();
+    for (uint64_t count : histogram.GetBins())
+        output << "," << count;
+    output << "\n";
+}
+
+void TransitStatistics::WriteSummary(ostream &output) {
+    output << "statistic,vessel,type,count,mean,stddev,min,max,median,p90\n";
+    for (auto &d : m_dwellTimes)
+        WriteDistribution(output, "dwellTime", d.first.first, d.first.second,
+                          d.second);
+    for (auto &o : m_occupancy) {
+        WriteMoments(output, "occupancy", o.first.first, o.first.second,
+                     o.second);
+        output << ",,\n";
+    }
+    for (auto &d : m_firstArrivalTimes)
+        WriteDistribution(output, "firstArrivalTime", 0, d.first, d.second);
+    for (auto &d : m_circulationTimes)
+        WriteDistribution(output, "circulationTime", 0, d.first, d.second);
+    for (auto &d : m_detections) {
+        WriteMoments(output, "detections", 0, d.first, d.second);
+        output << ",,\n";
+    }
+    for (auto &d : m_dwellTimes)
+        WriteHistogram(output, "dwellTime", d.first.first, d.first.second,
+                       d.second.histogram);
+    for (auto &d : m_firstArrivalTimes)
+        WriteHistogram(output, "firstArrivalTime", 0, d.first,
+                       d.second.histogram);
+    for (auto &d : m_circulationTimes)
+        WriteHistogram(output, "circulationTime", 0, d.first,
+                       d.second.histogram);
+}
+} // namespace experiments
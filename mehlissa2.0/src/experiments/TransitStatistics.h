@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_TRANSITSTATISTICS_
+#define CLASS_TRANSITSTATISTICS_
+
+#include "StatisticsStage.h"
+#include "../utils/StreamingStatistics.h"
+#include <unordered_map>
+#include <set>
+
+using namespace std;
+using namespace utils;
+
+namespace experiments {
+/**
+ * Moments, histogram, median and 90th percentile of one measured quantity.
+ */
+struct Distribution {
+    RunningMoments moments;
+    Histogram histogram;
+    P2Quantile median;
+    P2Quantile p90;
+
+    Distribution(double binWidth, size_t numberOfBins);
+
+    void Add(double value);
+};
+
+// What TransitStatistics knows about one Particle
+struct ParticleTrack {
+    int vesselID;
+    ParticleType type;
+    double birthTime;         // time the Particle was first observed
+    double entryTime;         // time it was first observed in its vessel
+    double gatewayTime;       // last arrival at a gateway vessel, -1 if none
+    bool entryObserved;       // false for the vessel it started in
+    int detections;           // Nanoparticle::GotDetected()
+    uint64_t lastSeen;        // step it was observed in last
+};
+
+/**
+ * \brief TransitStatistics measures by vessel and particle type
+ * - the dwell time, from the first step a Particle is observed in a vessel
+ *   to the first step it is observed in another one,
+ * - the occupancy, the number of Particles in the vessel per step,
+ * and by particle type
+ * - the first arrival time at a gateway vessel since the Particle was first
+ *   observed,
+ * - the circulation time between two arrivals at a gateway vessel,
+ * - the detection count of Nanoparticles, when they die or at the end.
+ *
+ * Particles are observed once per step, so vessels passed within a step are
+ * not seen. The vessel a Particle starts in has no dwell time.
+ */
+class TransitStatistics : public StatisticsStage {
+private:
+    map<pair<int, int>, Distribution> m_dwellTimes; // by vessel and type
+    map<pair<int, int>, RunningMoments> m_occupancy;
+    map<int, Distribution> m_firstArrivalTimes;     // by type
+    map<int, Distribution> m_circulationTimes;
+    map<int, RunningMoments> m_detections;
+    unordered_map<unsigned int, ParticleTrack> m_tracks; // by particle ID
+    set<int> m_types;                               // types observed so far
+    uint64_t m_steps;
+
+    void ObserveParticle(ParticleTrack &track, int vesselID, bool gateway,
+                         double time);
+
+    void EndTrack(const ParticleTrack &track);
+
+public:
+    TransitStatistics();
+
+    void ObserveStep(const map<int, shared_ptr<BloodVessel>> &vessels,
+                     double time) override;
+
+    void Finish() override;
+
+    /**
+     * Writes one line per quantity, vessel and type:
+     * statistic,vessel,type,count,mean,stddev,min,max,median,p90
+     * vessel is 0 for quantities by type only, occupancy has no quantiles.
+     * Then one line per histogram:
+     * histogram,statistic,vessel,type,binWidth,overflow,bin0,bin1,...
+     */
+    void WriteSummary(ostream &output) override;
+};
+}; // namespace experiments
+#endif
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "TransitTimeEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace experiments {
+
+TransitTimeEngine::TransitTimeEngine(shared_ptr<BloodCircuit> circuit,
+                                     int interactionStep) {
+    m_circuit = circuit;
+    m_interactionStep = interactionStep;
+    m_horizon = 0;
+    m_transitions = 0;
+}
+
+string TransitTimeEngine::FindUnsupported() {
+    if (Printer::outputFormat == EventFormat)
+        return "the event output is rebuilt with the stepped movement";
+    return "";
+}
+
+const vector<TransitTimeEngine::ResidenceTime> &
+TransitTimeEngine::GetTable(const shared_ptr<BloodVessel> &vessel, int stream,
+                            double delay) {
+    int vesselID = vessel->GetbloodvesselID();
+    auto key = make_tuple(vesselID, stream, delay);
+    auto table = m_tables.find(key);
+    if (table != m_tables.end())
+        return table->second;
+
+    vector<ResidenceTime> &samples = m_tables[key];
+    // the velocity factor keys the draws of the table
+    uint64_t bits;
+    memcpy(&bits, &delay, sizeof(bits));
+    uint32_t subKey = bits ^ (bits >> 32);
+    Position start = vessel->GetStartPositionBloodVessel();
+    for (int k = 0; k < SamplesPerTable; k++) {
+        KeyedRandom random(k, vesselID, stream,
+                           KeyedRandom::ResidenceTablePurpose, subKey);
+        int current = stream;
+        double arc = vessel->GetStream(current)->GetParticleStore().ArcOf(start);
+        ResidenceTime passage = {numeric_limits<double>::infinity(), stream};
+        for (int step = 1; step <= MaxPassageSteps; step++) {
+            // streams change in every second step
+            if (vessel->ChangesStreams() && step % 2 == 1 && random.GetBoolean())
+                current = vessel->NeighbourStream(current, random.GetBoolean());
+            ParticleStore &store = vessel->GetStream(current)->GetParticleStore();
+            // one second, the movement step of the vessels
+            double distance =
+                vessel->SampleStepDistance(current, delay, 1, random);
+            if (store.IsOutside(arc + distance)) {
+                // the Particle leaves within the step
+                double end = distance > 0 ? store.GetArcMax()
+                                          : store.GetArcMin();
+                double fraction = distance != 0 ? (end - arc) / distance : 1;
+                passage = {step - 1 + clamp(fraction, 0.0, 1.0), current};
+                break;
+            }
+            arc += distance;
+        }
+        samples.push_back(passage);
+    }
+    return samples;
+}
+
+void TransitTimeEngine::StartPassage(int particleID, TrackedParticle &particle,
+                                     double time, double entryArc) {
+    double delay = particle.placedVessel->GetStream(particle.placedStream)
+                       ->GetParticleStore()
+                       .GetDelay(particle.index);
+    ParticleStore &store =
+        particle.vessel->GetStream(particle.stream)->GetParticleStore();
+    const vector<ResidenceTime> &table =
+        GetTable(particle.vessel, particle.stream, delay);
+    KeyedRandom random(particle.transitions,
+                       particle.vessel->GetbloodvesselID(), particleID,
+                       KeyedRandom::ResidencePurpose);
+    const ResidenceTime &passage =
+        table[random.GetIntegerValue(0, table.size() - 1)];
+
+    particle.entryTime = time;
+    particle.entryArc = entryArc;
+    // a Particle placed inside the vessel only passes the rest of it
+    double start = store.ArcOf(particle.vessel->GetStartPositionBloodVessel());
+    double end = store.GetArcMax();
+    double remaining = 1;
+    if (isfinite(end) && end > start)
+        remaining = clamp((end - particle.entryArc) / (end - start), 0.0, 1.0);
+    particle.exitTime = time + passage.seconds * remaining;
+    particle.exitStream = passage.stream;
+    if (particle.exitTime <= m_horizon)
+        m_queue.push({particle.exitTime, particleID, particle.transitions});
+}
+
+void TransitTimeEngine::Scan(double time) {
+    unordered_map<int, TrackedParticle> particles;
+    particles.reserve(m_particles.size());
+    for (auto &entry : m_circuit->GetBloodCircuit()) {
+        shared_ptr<BloodVessel> vessel = entry.second;
+        for (int i = 0; i < vessel->GetNumberOfStreams(); i++) {
+            ParticleStore &store = vessel->GetStream(i)->GetParticleStore();
+            for (size_t j = 0; j < store.Size(); j++) {
+                int id = store.GetID(j);
+                auto known = m_particles.find(id);
+                if (known != m_particles.end() &&
+                    known->second.placedVessel == vessel &&
+                    known->second.placedStream == i) {
+                    TrackedParticle particle = known->second;
+                    particle.index = j;
+                    particles[id] = particle;
+                    continue;
+                }
+                // injected, born or placed at the start
+                TrackedParticle particle = {vessel, i, vessel, i, j,
+                                            0,      0, 0,      i, 0};
+                StartPassage(id, particle, time, store.GetArc(j));
+                particles[id] = particle;
+            }
+        }
+    }
+    swap(m_particles, particles);
+}
+
+void TransitTimeEngine::PlaceParticles(double time) {
+    for (auto &entry : m_particles) {
+        TrackedParticle &particle = entry.second;
+        ParticleStore &store =
+            particle.vessel->GetStream(particle.stream)->GetParticleStore();
+        if (particle.placedVessel != particle.vessel ||
+            particle.placedStream != particle.stream) {
+            ParticleStore &placed =
+                particle.placedVessel->GetStream(particle.placedStream)
+                    ->GetParticleStore();
+            shared_ptr<Particle> bot = particle.placedVessel->DepartParticle(
+                particle.placedStream, particle.index);
+            Removed(placed, particle.index);
+            bot->SetPosition(particle.vessel->GetStartPositionBloodVessel());
+            particle.vessel->EnterParticle(particle.stream, std::move(bot));
+            particle.placedVessel = particle.vessel;
+            particle.placedStream = particle.stream;
+            particle.index = store.Size() - 1;
+        }
+        double end = store.GetArcMax();
+        if (!isfinite(particle.exitTime) || !isfinite(end) ||
+            particle.exitTime <= particle.entryTime)
+            continue;
+        double fraction = clamp((time - particle.entryTime) /
+                                    (particle.exitTime - particle.entryTime),
+                                0.0, 1.0);
+        store.SetArc(particle.index, particle.entryArc +
+                                         (end - particle.entryArc) * fraction);
+    }
+}
+
+void TransitTimeEngine::Removed(ParticleStore &store, size_t index) {
+    if (index >= store.Size())
+        return;
+    auto moved = m_particles.find(store.GetID(index));
+    if (moved != m_particles.end())
+        moved->second.index = index;
+}
+
+void TransitTimeEngine::Depart(const Departure &departure) {
+    auto found = m_particles.find(departure.particleID);
+    // removed by the coarse steps, or a passage drawn before
+    if (found == m_particles.end() ||
+        found->second.transitions != departure.transitions)
+        return;
+    TrackedParticle &particle = found->second;
+    KeyedRandom random(particle.transitions,
+                       particle.vessel->GetbloodvesselID(),
+                       departure.particleID, KeyedRandom::TransitionPurpose);
+    particle.vessel = particle.vessel->ChooseNextVessel(random);
+    particle.stream = particle.exitStream;
+    particle.transitions++;
+    m_transitions++;
+    ParticleStore &store =
+        particle.vessel->GetStream(particle.stream)->GetParticleStore();
+    StartPassage(departure.particleID, particle, departure.time,
+                 store.ArcOf(particle.vessel->GetStartPositionBloodVessel()));
+}
+
+int TransitTimeEngine::Simulate(uint64_t numberOfSeconds) {
+    cout << "Simulating transit times with interactions every "
+         << m_interactionStep << "s." << endl;
+    map<int, shared_ptr<BloodVessel>> vessels = m_circuit->GetBloodCircuit();
+    m_horizon = numberOfSeconds + m_interactionStep;
+    Scan(GlobalTimer::NowInSeconds());
+
+    while (GlobalTimer::NowInSeconds() <= numberOfSeconds) {
+        uint64_t now = GlobalTimer::NowInSeconds();
+        cout << now << "s" << endl;
+        PlaceParticles(now);
+        for (auto &entry : vessels)
+            entry.second->StepCoarse(now, m_interactionStep);
+        // in ID order, like Simulator::AddBirths()
+        for (auto &entry : vessels)
+            entry.second->AddBirths();
+        Scan(now);
+        for (auto &entry : vessels)
+            entry.second->PrintParticlesOfVessel();
+        m_circuit->FinishStep();
+        GlobalTimer::IncreaseTimer(m_interactionStep);
+
+        double until = GlobalTimer::NowInSeconds();
+        while (!m_queue.empty() && m_queue.top().time < until) {
+            Departure departure = m_queue.top();
+            m_queue.pop();
+            Depart(departure);
+        }
+    }
+    cout << "Performed " << m_transitions << " transitions of "
+         << m_particles.size() << " particles." << endl;
+    return GlobalTimer::NowInSeconds();
+}
+} // namespace experiments
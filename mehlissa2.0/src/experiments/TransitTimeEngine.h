@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_TRANSITTIMEENGINE_
+#define CLASS_TRANSITTIMEENGINE_
+
+#include "../bloodcircuit/BloodCircuit.h"
+#include "../bloodcircuit/BloodVessel.h"
+#include "../utils/GlobalTimer.h"
+#include "../utils/KeyedRandom.h"
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace bloodcircuit;
+using namespace utils;
+
+namespace experiments {
+/**
+ * \brief TransitTimeEngine simulates long horizons by moving the Particles
+ * as a semi-Markov process over the vessel graph.
+ *
+ * For every vessel, stream and velocity factor a table of residence times is
+ * sampled once. Each sample passes the vessel with the per-step velocity
+ * offsets and stream changes of the stepped simulation. It records the time,
+ * with the fraction of the last step, and the stream in which the vessel
+ * ends. A Particle entering a vessel draws one sample. It leaves at the
+ * sampled time and moves to the next vessel chosen with the transition
+ * probabilities of the vessel. Departures wait in a priority queue in
+ * continuous time, so no Particle is touched between two vessels.
+ *
+ * Interactions, aging, mitoses, injections, gateway counts and the output
+ * happen in coarse steps of interactionStep seconds (BloodVessel::
+ * StepCoarse()). Before a coarse step, the Particles are moved into the
+ * vessel of their passage and placed at the arc length of the elapsed
+ * fraction of their residence. The kill and mitosis probabilities apply once
+ * per coarse step, as they do once per step in the stepped simulation.
+ *
+ * Unlike the EventDrivenEngine the result is an approximation: within a
+ * vessel the Particles are spread by the sampled residence times only, and
+ * they enter every vessel at its start.
+ */
+class TransitTimeEngine {
+private:
+    // Sampled passage through a vessel
+    struct ResidenceTime {
+        double seconds; // infinite if the Particle never leaves
+        int stream;     // stream at the end of the vessel
+    };
+
+    // Current passage of a Particle and the store holding it
+    struct TrackedParticle {
+        shared_ptr<BloodVessel> vessel; // of the passage
+        int stream;
+        shared_ptr<BloodVessel> placedVessel; // of the store
+        int placedStream;
+        size_t index;
+        double entryTime;
+        double entryArc;
+        double exitTime;
+        int exitStream;
+        uint64_t transitions; // vessels entered, keys the random draws
+    };
+
+    struct Departure {
+        double time;
+        int particleID;
+        uint64_t transitions; // of the Particle when it was predicted
+    };
+
+    struct Later {
+        bool operator()(const Departure &a, const Departure &b) {
+            if (a.time != b.time)
+                return a.time > b.time;
+            return a.particleID > b.particleID;
+        }
+    };
+
+    shared_ptr<BloodCircuit> m_circuit;
+    int m_interactionStep; // in seconds
+    map<tuple<int, int, double>, vector<ResidenceTime>> m_tables;
+    unordered_map<int, TrackedParticle> m_particles;
+    priority_queue<Departure, vector<Departure>, Later> m_queue;
+    double m_horizon; // departures after it are not queued
+    size_t m_transitions;
+
+    // Samples the residence times of stream for Particles with delay.
+    const vector<ResidenceTime> &GetTable(const shared_ptr<BloodVessel> &vessel,
+                                          int stream, double delay);
+
+    // Draws the passage of the Particle, starting in the vessel at time and
+    // entryArc.
+    void StartPassage(int particleID, TrackedParticle &particle, double time,
+                      double entryArc);
+
+    // Updates indices and passages after the coarse step: new Particles
+    // start their passage, removed ones are forgotten.
+    void Scan(double time);
+
+    // Moves the Particles into the stores of their passages and sets their
+    // arc lengths to the estimate at time.
+    void PlaceParticles(double time);
+
+    // Starts the next passage. The Particle stays in its store until
+    // PlaceParticles(), so passages shorter than a coarse step cost no
+    // store operations.
+    void Depart(const Departure &departure);
+
+    // Updates the index of the Particle that took over index after a removal
+    // from store.
+    void Removed(ParticleStore &store, size_t index);
+
+public:
+    // passages sampled per table
+    static const int SamplesPerTable = 256;
+
+    // the passages of the tables end after this many steps
+    static const int MaxPassageSteps = 100000;
+
+    /// \param interactionStep seconds between two coarse steps.
+    TransitTimeEngine(shared_ptr<BloodCircuit> circuit, int interactionStep);
+
+    /**
+     * \returns why the transit-time mode cannot be used with the current
+     * output, or an empty string if it can.
+     */
+    static string FindUnsupported();
+
+    /**
+     * Simulates up to numberOfSeconds.
+     * \returns the simulated time in seconds.
+     */
+    int Simulate(uint64_t numberOfSeconds);
+
+    /// \returns the number of vessel transitions performed.
+    size_t GetTransitions() { return m_transitions; }
+};
+}; // namespace experiments
+#endif
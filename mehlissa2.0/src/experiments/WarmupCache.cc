@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "WarmupCache.h"
+#include <iomanip>
+#include <sstream>
+
+namespace experiments {
+
+// FNV-1a parameters for 64 bit
+const uint64_t FnvOffsetBasis = 14695981039346656037ull;
+const uint64_t FnvPrime = 1099511628211ull;
+
+WarmupCache::WarmupCache(string directory) {
+    m_directory = directory;
+    m_key = FnvOffsetBasis;
+    filesystem::create_directories(directory);
+}
+
+void WarmupCache::Add(const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        m_key ^= (unsigned char)data[i];
+        m_key *= FnvPrime;
+    }
+}
+
+void WarmupCache::AddFile(string file) {
+    ifstream in(file, ios::in | ios::binary);
+    // the simulation runs without optional files, e.g. the fingerprints
+    if (!in) {
+        AddParameter("absent", file);
+        return;
+    }
+    char buffer[1 << 16];
+    while (in) {
+        in.read(buffer, sizeof(buffer));
+        Add(buffer, in.gcount());
+    }
+    // separates the contents from the next entry
+    Add("", 1);
+}
+
+void WarmupCache::AddParameter(string name, string value) {
+    string entry = name + "=" + value;
+    Add(entry.c_str(), entry.size() + 1);
+}
+
+string WarmupCache::GetFile() {
+    stringstream name;
+    name << "warmup-" << hex << setw(16) << setfill('0') << m_key << ".bin";
+    return (filesystem::path(m_directory) / name.str()).string();
+}
+
+bool WarmupCache::HasState() { return filesystem::exists(GetFile()); }
+} // namespace experiments
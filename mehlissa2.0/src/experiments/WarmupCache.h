@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_WARMUPCACHE_
+#define CLASS_WARMUPCACHE_
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace experiments {
+/**
+ * \brief WarmupCache stores the state a simulation reaches before the
+ * injection, so runs with the same setup skip the warm-up.
+ *
+ * The state is saved as a Checkpoint in the cache directory. Its file name
+ * is a 64 bit FNV-1a hash of everything that decides the state: the
+ * contents of the input files and the parameters added by the caller, e.g.
+ * the population sizes, the simulation step and the seed.
+ */
+class WarmupCache {
+private:
+    string m_directory;
+    uint64_t m_key; // hash of the files and parameters added so far
+
+    // Adds size bytes of data to the key.
+    void Add(const char *data, size_t size);
+
+public:
+    /// \param directory of the cached states, created if needed.
+    WarmupCache(string directory);
+
+    /// Adds the contents of file to the key, or that it does not exist.
+    void AddFile(string file);
+
+    /// Adds a parameter that changes the state to the key.
+    void AddParameter(string name, string value);
+
+    /// \returns the file of the state with the current key.
+    string GetFile();
+
+    /// \returns true if a state with the current key is cached.
+    bool HasState();
+};
+}; // namespace experiments
+#endif
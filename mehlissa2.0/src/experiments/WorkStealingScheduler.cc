@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+
+namespace experiments {
+
+WorkStealingScheduler::WorkStealingScheduler(int numberOfThreads) {
+    m_numberOfThreads = numberOfThreads < 1 ? 1 : numberOfThreads;
+    m_queues.resize(m_numberOfThreads);
+    m_remainingLoad.resize(m_numberOfThreads, 0);
+    for (int i = 0; i < m_numberOfThreads; i++)
+        m_queueMutexes.push_back(make_unique<mutex>());
+    m_busyTime.resize(m_numberOfThreads, 0);
+    m_processedLoad.resize(m_numberOfThreads, 0);
+    m_steals.resize(m_numberOfThreads, 0);
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {}
+
+void WorkStealingScheduler::Run(
+    const list<shared_ptr<BloodVessel>> &vessels,
+    function<size_t(shared_ptr<BloodVessel>)> weight,
+    function<void(shared_ptr<BloodVessel>)> task) {
+    // Longest processing time first: sort by weight and always hand the next
+    // task to the thread with the least assigned load.
+    vector<Task> tasks;
+    for (const shared_ptr<BloodVessel> &bv : vessels)
+        tasks.push_back({bv, weight(bv)});
+    stable_sort(tasks.begin(), tasks.end(), [](const Task &a, const Task &b) {
+        return a.weight > b.weight;
+    });
+    for (int i = 0; i < m_numberOfThreads; i++) {
+        m_queues[i].clear();
+        m_remainingLoad[i] = 0;
+        m_busyTime[i] = 0;
+        m_processedLoad[i] = 0;
+        m_steals[i] = 0;
+    }
+    for (const Task &t : tasks) {
+        int target = min_element(m_remainingLoad.begin(),
+                                 m_remainingLoad.end()) -
+                     m_remainingLoad.begin();
+        m_queues[target].push_back(t);
+        // count every task at least once, so empty vessels are spread as well
+        m_remainingLoad[target] += t.weight + 1;
+    }
+
+    #pragma omp parallel num_threads(m_numberOfThreads)
+    {
+        int thread = omp_get_thread_num();
+        Task t;
+        while (PopOwnTask(thread, t) || StealTask(thread, t)) {
+            double start = omp_get_wtime();
+            task(t.vessel);
+            m_busyTime[thread] += omp_get_wtime() - start;
+            m_processedLoad[thread] += t.weight;
+        }
+    }
+}
+
+bool WorkStealingScheduler::PopOwnTask(int thread, Task &task) {
+    const std::lock_guard<std::mutex> lock(*m_queueMutexes[thread]);
+    if (m_queues[thread].size() <= 0)
+        return false;
+    task = m_queues[thread].front();
+    m_queues[thread].pop_front();
+    m_remainingLoad[thread] -= task.weight + 1;
+    return true;
+}
+
+bool WorkStealingScheduler::StealTask(int thread, Task &task) {
+    while (true) {
+        // pick the victim with the most remaining load
+        int victim = -1;
+        size_t maxLoad = 0;
+        for (int i = 0; i < m_numberOfThreads; i++) {
+            if (i == thread)
+                continue;
+            const std::lock_guard<std::mutex> lock(*m_queueMutexes[i]);
+            if (m_queues[i].size() > 0 && m_remainingLoad[i] > maxLoad) {
+                maxLoad = m_remainingLoad[i];
+                victim = i;
+            }
+        }
+        if (victim < 0)
+            return false;
+        const std::lock_guard<std::mutex> lock(*m_queueMutexes[victim]);
+        // the victim may have emptied its queue in the meantime
+        if (m_queues[victim].size() <= 0)
+            continue;
+        task = m_queues[victim].back();
+        m_queues[victim].pop_back();
+        m_remainingLoad[victim] -= task.weight + 1;
+        m_steals[thread]++;
+        return true;
+    }
+}
+
+double WorkStealingScheduler::GetImbalance() {
+    double maxTime = 0;
+    double sumTime = 0;
+    for (int i = 0; i < m_numberOfThreads; i++) {
+        maxTime = max(maxTime, m_busyTime[i]);
+        sumTime += m_busyTime[i];
+    }
+    if (sumTime <= 0)
+        return 1;
+    return maxTime / (sumTime / m_numberOfThreads);
+}
+
+int WorkStealingScheduler::GetSteals() {
+    int steals = 0;
+    for (int i = 0; i < m_numberOfThreads; i++)
+        steals += m_steals[i];
+    return steals;
+}
+
+size_t WorkStealingScheduler::GetMaxProcessedLoad() {
+    return *max_element(m_processedLoad.begin(), m_processedLoad.end());
+}
+
+size_t WorkStealingScheduler::GetTotalLoad() {
+    size_t load = 0;
+    for (int i = 0; i < m_numberOfThreads; i++)
+        load += m_processedLoad[i];
+    return load;
+}
+} // namespace experiments
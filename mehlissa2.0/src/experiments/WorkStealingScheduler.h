@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_WORKSTEALINGSCHEDULER_
+#define CLASS_WORKSTEALINGSCHEDULER_
+
+#include "../bloodcircuit/BloodVessel.h"
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <omp.h>
+
+using namespace std;
+using namespace bloodcircuit;
+
+namespace experiments {
+/**
+ * \brief WorkStealingScheduler distributes the BloodVessels of one phase of a
+ * simulation step onto a fixed number of threads.
+ *
+ * Each vessel is one task weighted by its expected load (e.g. its number of
+ * particles). The tasks are assigned largest first to the thread with the
+ * least assigned load. A thread that runs out of tasks steals from the back of
+ * the queue with the most remaining load.
+ */
+class WorkStealingScheduler {
+private:
+    struct Task {
+        shared_ptr<BloodVessel> vessel;
+        size_t weight;
+    };
+
+    int m_numberOfThreads;
+    vector<deque<Task>> m_queues;          // one task queue per thread
+    vector<size_t> m_remainingLoad;        // summed weight left per queue
+    vector<unique_ptr<mutex>> m_queueMutexes;
+
+    // Statistics of the last call to Run()
+    vector<double> m_busyTime;             // seconds spent in tasks per thread
+    vector<size_t> m_processedLoad;        // summed weight processed per thread
+    vector<int> m_steals;                  // tasks stolen per thread
+
+    bool PopOwnTask(int thread, Task &task);
+
+    bool StealTask(int thread, Task &task);
+
+public:
+    WorkStealingScheduler(int numberOfThreads);
+
+    ~WorkStealingScheduler();
+
+    /**
+     * Runs task for every vessel and returns when all tasks are done.
+     * \param vessels to process.
+     * \param weight returns the expected load of a vessel.
+     * \param task is performed once per vessel.
+     */
+    void Run(const list<shared_ptr<BloodVessel>> &vessels,
+             function<size_t(shared_ptr<BloodVessel>)> weight,
+             function<void(shared_ptr<BloodVessel>)> task);
+
+    /**
+     * \returns the busy time of the slowest thread divided by the mean busy
+     * time of all threads during the last run (1 = perfectly balanced).
+     */
+    double GetImbalance();
+
+    /**
+     * \returns the number of tasks stolen during the last run.
+     */
+    int GetSteals();
+
+    /**
+     * \returns the largest summed weight processed by one thread during the
+     * last run.
+     */
+    size_t GetMaxProcessedLoad();
+
+    /**
+     * \returns the summed weight of all tasks of the last run.
+     */
+    size_t GetTotalLoad();
+};
+}; // namespace experiments
+#endif
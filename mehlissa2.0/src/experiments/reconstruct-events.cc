@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "../bloodcircuit/BloodCircuit.h"
+#include <iostream>
+#include <boost/program_options.hpp>
+
+using namespace std;
+using namespace bloodcircuit;
+namespace po = boost::program_options;
+
+// A Particle rebuilt from the event output
+struct ReplayedParticle {
+    ParticleRecord record; // vessel, stream, position and flags
+    double arc;            // distance along the stream
+    double delay;          // velocity factor
+    uint64_t timeStep;     // second of the last movement
+    uint64_t birthStep;
+};
+
+// reads one column of a chunk into the given field of all events
+template <typename T>
+static void ReadColumn(ifstream &input, vector<ParticleEvent> &events,
+                       T ParticleEvent::*field) {
+    for (ParticleEvent &e : events)
+        input.read((char *)&(e.*field), sizeof(T));
+}
+
+static bool ReadChunk(ifstream &input, uint64_t &step, double &time,
+                      vector<ParticleEvent> &events) {
+    uint64_t count;
+    input.read((char *)&step, sizeof(step));
+    input.read((char *)&time, sizeof(time));
+    input.read((char *)&count, sizeof(count));
+    if (!input)
+        return false;
+    events.resize(count);
+    ReadColumn(input, events, &ParticleEvent::id);
+    ReadColumn(input, events, &ParticleEvent::kind);
+    ReadColumn(input, events, &ParticleEvent::vesselID);
+    ReadColumn(input, events, &ParticleEvent::stream);
+    ReadColumn(input, events, &ParticleEvent::x);
+    ReadColumn(input, events, &ParticleEvent::y);
+    ReadColumn(input, events, &ParticleEvent::z);
+    ReadColumn(input, events, &ParticleEvent::arc);
+    ReadColumn(input, events, &ParticleEvent::type);
+    ReadColumn(input, events, &ParticleEvent::delay);
+    ReadColumn(input, events, &ParticleEvent::isNl);
+    ReadColumn(input, events, &ParticleEvent::target);
+    ReadColumn(input, events, &ParticleEvent::detected);
+    if (!input)
+        throw runtime_error("Truncated event chunk of step " +
+                            to_string(step));
+    return true;
+}
+
+static void PlaceParticle(ReplayedParticle &particle, const ParticleEvent &e) {
+    particle.record.vesselID = e.vesselID;
+    particle.record.stream = e.stream;
+    particle.record.x = e.x;
+    particle.record.y = e.y;
+    particle.record.z = e.z;
+    particle.arc = e.arc;
+}
+
+static ReplayedParticle BirthOf(const ParticleEvent &e, uint64_t step) {
+    ReplayedParticle particle;
+    particle.record.id = e.id;
+    particle.record.isNc = (bool)e.delay;
+    particle.record.isNl = e.isNl;
+    particle.record.target = e.target;
+    particle.record.detected = e.detected;
+    particle.record.type = e.type;
+    particle.record.npDetected = -1;
+    particle.delay = e.delay;
+    // a new Particle moves in the step after its birth
+    particle.timeStep = 0;
+    particle.birthStep = step;
+    PlaceParticle(particle, e);
+    return particle;
+}
+
+/**
+ * Rebuilds the particle output of a simulation from its event output. Within
+ * a step the events are applied first, then every Particle that has not moved
+ * in this second is moved like BloodVessel::TranslatePosition() does, with
+ * the random values of the recorded seed. Entered Particles were moved by the
+ * vessel they left, they are printed at their entry position.
+ */
+int
+main (int argc, char *argv[])
+{
+    try {
+        string eventFile;
+        string simFile;
+        string outputFormat;
+        int outputEvery;
+        string outputIDs;
+        double outputSampleRate;
+        string outputTypes;
+        string networkFile;
+        string transitionsFile;
+        string fingerprintFile;
+
+        po::options_description desc("Allowed options");
+        desc.add_options()
+            ("eventFile", po::value<string>(&eventFile)->default_value("csvnano.csv"), "eventFile")
+            ("simFile", po::value<string>(&simFile)->default_value("reconstructed.csv"), "simFile")
+            ("outputFormat", po::value<string>(&outputFormat)->default_value("csv"), "outputFormat")
+            ("outputEvery", po::value<int>(&outputEvery)->default_value(1), "outputEvery")
+            ("outputIDs", po::value<string>(&outputIDs)->default_value(""), "outputIDs")
+            ("outputSampleRate", po::value<double>(&outputSampleRate)->default_value(1), "outputSampleRate")
+            ("outputTypes", po::value<string>(&outputTypes)->default_value(""), "outputTypes")
+            ("networkFile", po::value<string>(&networkFile)->default_value("../data/95_vasculature.csv"), "networkFile")
+            ("transitionsFile", po::value<string>(&transitionsFile)->default_value("../data/95_transitions.csv"), "transitionsFile")
+            ("fingerprintFile", po::value<string>(&fingerprintFile)->default_value("../data/95_fingerprint.csv"), "fingerprintFile")
+        ;
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        ifstream input(eventFile, ios::in | ios::binary);
+        char magic[8];
+        uint64_t seed;
+        input.read(magic, sizeof(magic));
+        input.read((char *)&seed, sizeof(seed));
+        if (!input || string(magic, sizeof(magic)) != "MEHLEVT2")
+            throw runtime_error("Not an event file: " + eventFile);
+        Randomizer::SetSeed(seed);
+
+        BloodCircuit::SetVasculature(networkFile, transitionsFile, fingerprintFile);
+        Printer::SetOutputFormat(outputFormat);
+        if (Printer::outputFormat == EventFormat)
+            throw runtime_error("Cannot reconstruct into events");
+        Printer::outputPolicy.SetEveryKSteps(outputEvery);
+        Printer::outputPolicy.SetIDs(outputIDs);
+        Printer::outputPolicy.SetSampleRate(outputSampleRate);
+        Printer::outputPolicy.SetTypes(outputTypes);
+        shared_ptr<Printer> printer = make_shared<Printer>(0, simFile, "");
+        shared_ptr<BloodCircuit> circuit = make_shared<BloodCircuit>(printer);
+        map<int, shared_ptr<BloodVessel>> vessels = circuit->GetBloodCircuit();
+
+        GlobalTimer::ResetTimer();
+        map<int32_t, ReplayedParticle> particles;
+        vector<ParticleEvent> events;
+        vector<ParticleRecord> print;
+        uint64_t step;
+        double time;
+        while (ReadChunk(input, step, time, events)) {
+            // the Printer takes the step from the timer
+            while (GlobalTimer::GetStep() + 1 < step)
+                GlobalTimer::IncreaseTimer(0);
+            if (GlobalTimer::GetStep() < step)
+                GlobalTimer::IncreaseTimer(time - GlobalTimer::NowInSeconds());
+            bool recordStep = printer->RecordsStep(step);
+            print.clear();
+
+            // the events of a Particle are in the order they happened
+            for (const ParticleEvent &e : events) {
+                switch (e.kind) {
+                case BirthEvent:
+                    particles[e.id] = BirthOf(e, step);
+                    break;
+                case EntryEvent: {
+                    auto particle = particles.find(e.id);
+                    if (particle == particles.end())
+                        particle = particles.insert({e.id, BirthOf(e, step)})
+                                       .first;
+                    PlaceParticle(particle->second, e);
+                    particle->second.timeStep = time;
+                    particle->second.record.time = time;
+                    if (recordStep &&
+                        printer->RecordsParticle(e.id, (ParticleType)e.type))
+                        print.push_back(particle->second.record);
+                    break;
+                }
+                case StreamChangeEvent: {
+                    auto particle = particles.find(e.id);
+                    if (particle != particles.end())
+                        PlaceParticle(particle->second, e);
+                    break;
+                }
+                case DeathEvent:
+                    particles.erase(e.id);
+                    break;
+                default:
+                    // exits are followed by the entry into the next vessel
+                    break;
+                }
+            }
+
+            for (auto &p : particles) {
+                ReplayedParticle &particle = p.second;
+                if (particle.birthStep == step || particle.timeStep >= time)
+                    continue;
+                ParticleRecord &record = particle.record;
+                Position position;
+                bool reachedEnd = vessels[record.vesselID]->ReplayMovement(
+                    record.id, record.stream, particle.delay, step,
+                    particle.arc, position);
+                record.x = position.x;
+                record.y = position.y;
+                record.z = position.z;
+                record.time = time;
+                particle.timeStep = time;
+                // a Particle that left is printed at its entry
+                if (!reachedEnd && recordStep &&
+                    printer->RecordsParticle(record.id,
+                                             (ParticleType)record.type))
+                    print.push_back(record);
+            }
+            if (print.size() > 0)
+                printer->PrintRecords(print);
+            printer->FinishStep();
+        }
+        printer->Close();
+    } catch (const exception &e) {
+        cout << "Exception " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -18,6 +18,7 @@
  */
 
 #include "Simulator.h"
+#include "TransitStatistics.h"
 #include "../bloodcircuit/BloodCircuit.h"
 #include <iostream>
 //#include "../libs/boost_1_82_0/boost/program_options.hpp"
@@ -42,11 +43,26 @@ main (int argc, char *argv[])
         double simStep;
         double injectionTime;
         int injectionVessel;
-        int detectionVessel;
+        string detectionVessels;
         bool isDeterministic;
+        bool stationaryStart;
         int parallel;
+        bool batchInteractions;
+        bool eventDriven;
+        int transitTimeStep;
         string simFile;
         string gwFile;
+        string outputFormat;
+        int outputEvery;
+        string outputIDs;
+        double outputSampleRate;
+        string outputTypes;
+        string statisticsFile;
+        string checkpointFile;
+        int checkpointEvery;
+        bool resume;
+        string branches;
+        string warmupCache;
         string networkFile;
         string transitionsFile;
         string fingerprintFile;
@@ -61,11 +77,26 @@ main (int argc, char *argv[])
             ("simulationDuration", po::value<int>(&simulationDuration)->default_value(100), "simulationDuration")
             ("injectionTime", po::value<double>(&injectionTime)->default_value(20), "injectionTime")
             ("injectionVessel", po::value<int>(&injectionVessel)->default_value(29), "injectionVessel")
-            ("detectionVessel", po::value<int>(&detectionVessel)->default_value(23), "detectionVessel")
+            ("detectionVessel", po::value<string>(&detectionVessels)->default_value("23"), "detectionVessel")
             ("isDeterministic", po::value<bool>(&isDeterministic)->default_value(true), "isDeterministic")
+            ("stationaryStart", po::value<bool>(&stationaryStart)->default_value(false), "stationaryStart")
             ("parallel", po::value<int>(&parallel)->default_value(1), "parallel")
+            ("batchInteractions", po::value<bool>(&batchInteractions)->default_value(false), "batchInteractions")
+            ("eventDriven", po::value<bool>(&eventDriven)->default_value(false), "eventDriven")
+            ("transitTimeStep", po::value<int>(&transitTimeStep)->default_value(0), "transitTimeStep")
             ("simFile", po::value<string>(&simFile)->default_value("csvnano.csv"), "simFile")
             ("gwFile", po::value<string>(&gwFile)->default_value("gwDetect.csv"), "gwFile")
+            ("outputFormat", po::value<string>(&outputFormat)->default_value("csv"), "outputFormat")
+            ("outputEvery", po::value<int>(&outputEvery)->default_value(1), "outputEvery")
+            ("outputIDs", po::value<string>(&outputIDs)->default_value(""), "outputIDs")
+            ("outputSampleRate", po::value<double>(&outputSampleRate)->default_value(1), "outputSampleRate")
+            ("outputTypes", po::value<string>(&outputTypes)->default_value(""), "outputTypes")
+            ("statisticsFile", po::value<string>(&statisticsFile)->default_value(""), "statisticsFile")
+            ("checkpointFile", po::value<string>(&checkpointFile)->default_value("checkpoint.bin"), "checkpointFile")
+            ("checkpointEvery", po::value<int>(&checkpointEvery)->default_value(0), "checkpointEvery")
+            ("resume", po::value<bool>(&resume)->default_value(false), "resume")
+            ("branches", po::value<string>(&branches)->default_value(""), "branches")
+            ("warmupCache", po::value<string>(&warmupCache)->default_value(""), "warmupCache")
             ("networkFile", po::value<string>(&networkFile)->default_value("../data/95_vasculature.csv"), "networkFile")
             ("transitionsFile", po::value<string>(&transitionsFile)->default_value("../data/95_transitions.csv"), "transitionsFile")
             ("fingerprintFile", po::value<string>(&fingerprintFile)->default_value("../data/95_fingerprint.csv"), "fingerprintFile")
@@ -75,21 +106,97 @@ main (int argc, char *argv[])
         po::notify(vm);
 
         BloodCircuit::SetVasculature(networkFile, transitionsFile, fingerprintFile);
-        shared_ptr<BloodCircuit> circuit =  BloodCircuit::CancerSimulation(numCancerCells,
-                                                               numCarTCells,
-                                                               numTCells,
+        BloodVessel::batchInteractions = batchInteractions;
+        BloodCircuit::stationaryStart = stationaryStart;
+        Printer::SetOutputFormat(outputFormat);
+        Printer::outputPolicy.SetEveryKSteps(outputEvery);
+        Printer::outputPolicy.SetIDs(outputIDs);
+        Printer::outputPolicy.SetSampleRate(outputSampleRate);
+        Printer::outputPolicy.SetTypes(outputTypes);
+        // the seed of a deterministic run is fixed, others cannot hit the
+        // warm-up cache
+        shared_ptr<WarmupCache> cache;
+        unsigned int cacheSeed = 0;
+        if (warmupCache != "" && isDeterministic && !resume && branches == "" &&
+            injectionTime >= 1) {
+            // the hit decides how many cells the circuit is built with, so
+            // the seed is set up for the key before the circuit
+            Randomizer::InitRandomizer(isDeterministic);
+            cacheSeed = Randomizer::GetSeed();
+            // everything that decides the state before the injection
+            cache = make_shared<WarmupCache>(warmupCache);
+            cache->AddParameter("checkpointFormat", Checkpoint::GetFormat());
+            cache->AddFile(networkFile);
+            cache->AddFile(transitionsFile);
+            cache->AddFile(fingerprintFile);
+            cache->AddParameter("numCancerCells", to_string(numCancerCells));
+            cache->AddParameter("numTCells", to_string(numTCells));
+            cache->AddParameter("simulationStep", to_string(simStep));
+            cache->AddParameter("seed", to_string(cacheSeed));
+            cache->AddParameter("injectionTime", to_string((unsigned int)injectionTime));
+            cache->AddParameter("injectionVessel", to_string(injectionVessel));
+            cache->AddParameter("stationaryStart", to_string(stationaryStart));
+            cache->AddParameter("batchInteractions", to_string(batchInteractions));
+            cache->AddParameter("eventDriven", to_string(eventDriven));
+            cache->AddParameter("transitTimeStep", to_string(transitTimeStep));
+        }
+        // the cells of a resumed or warm run come from the saved state
+        bool restored = resume || (cache != nullptr && cache->HasState());
+        if (resume) {
+            // the output continues where the checkpoint was saved, the cells
+            // come from the checkpoint
+            Printer::resumeOutput = true;
+            Printer::resumeOffsets = Checkpoint::ReadOutputOffsets(checkpointFile);
+        }
+        shared_ptr<BloodCircuit> circuit =  BloodCircuit::CancerSimulation(restored ? 0 : numCancerCells,
+                                                               resume || branches != "" ? 0 : numCarTCells,
+                                                               restored ? 0 : numTCells,
                                                                simulationDuration,
                                                                injectionTime,
                                                                injectionVessel, 
-                                                               detectionVessel,
+                                                               BloodCircuit::ParseVesselIDs(detectionVessels),
                                                                isDeterministic,
                                                                simFile,
                                                                gwFile);
+        if (cache != nullptr && Randomizer::GetSeed() != cacheSeed)
+            throw runtime_error("The circuit was built with another seed than "
+                                "the warm-up cache key");
 
         Simulator simulator(parallel, simStep, circuit);
+        simulator.SetEventDriven(eventDriven);
+        simulator.SetTransitTimeStep(transitTimeStep);
+        if (checkpointEvery > 0)
+            simulator.SetCheckpoints(checkpointFile, checkpointEvery);
+        if (resume)
+            simulator.Resume(checkpointFile);
+        shared_ptr<TransitStatistics> statistics;
+        if (statisticsFile != "") {
+            statistics = make_shared<TransitStatistics>();
+            simulator.AddStatisticsStage(statistics);
+        }
         start = clock();
-        simulator.Simulate(simulationDuration);
+        if (branches != "") {
+            // the shared prefix lasts until the earliest injection, every
+            // branch draws its own random values after it
+            vector<Branch> variants = Simulator::ParseBranches(branches);
+            uint64_t forkTime = simulationDuration;
+            for (size_t k = 0; k < variants.size(); k++) {
+                forkTime = min<uint64_t>(forkTime, variants[k].injectionTime);
+                variants[k].seed = Randomizer::GetSeed() + k + 1;
+                variants[k].simFile = Simulator::BranchFile(simFile, k + 1);
+                variants[k].gwFile = gwFile == "" ? "" : Simulator::BranchFile(gwFile, k + 1);
+            }
+            simulator.SimulateBranches(forkTime, simulationDuration, variants);
+        } else if (cache != nullptr) {
+            simulator.SimulateWithWarmup(cache, (unsigned int)injectionTime, simulationDuration);
+        } else {
+            simulator.Simulate(simulationDuration);
+        }
         finish = clock();
+        if (statistics != nullptr) {
+            ofstream summary(statisticsFile, ios::out | ios::trunc);
+            statistics->WriteSummary(summary);
+        }
         cout << "Time total: " << simulationDuration << "s " << endl;
         cout << numCancerCells << " cancer cells, "
              << numCarTCells << " CAR-T cells, "
@@ -38,4 +38,18 @@ CancerCell::~CancerCell() {}
 bool CancerCell::MustBeDeleted() { return m_got_detected > 0; }
 
 void CancerCell::SetDelay(double value) {}
+
+void CancerCell::SaveState(ostream &out) {
+    Nanoparticle::SaveState(out);
+    WriteState(out, m_delay);
+    WriteState(out, m_got_detected);
+    WriteState(out, m_detectionRadius);
+}
+
+void CancerCell::LoadState(istream &in) {
+    Nanoparticle::LoadState(in);
+    ReadState(in, m_delay);
+    ReadState(in, m_got_detected);
+    ReadState(in, m_detectionRadius);
+}
 } // namespace particles
@@ -30,7 +30,7 @@ class CancerCell;
  * CarTCell objects.
  */
 
-class CancerCell : public Nanoparticle {
+class CancerCell final : public Nanoparticle {
 private:
     double m_delay;     // factor for changed travelling  speed
     int m_got_detected; // counts up if particle was detected by nanobot
@@ -52,6 +52,10 @@ public:
      * Only the delay calculated in the constructor is used.
      */
     void SetDelay(double value);
+
+    void SaveState(ostream &out) override;
+
+    void LoadState(istream &in) override;
 };
 }; // namespace particles
 #endif
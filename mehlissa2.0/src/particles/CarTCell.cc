@@ -72,6 +72,44 @@ double CarTCell::GetTFratricideP() { return m_tFratricideP; }
 
 double CarTCell::GetCarTFratricideP() { return m_carTFratricideP; }
 
+double CarTCell::GetFratricideP(ParticleType type, int seconds) {
+    double fratricideP = 0;
+    switch (type) {
+    case CancerCellType:
+        fratricideP = m_cancerFratricideP;
+        break;
+    case TCellType:
+        fratricideP = m_tFratricideP;
+        break;
+    case CarTCellType:
+        fratricideP = m_carTFratricideP;
+        break;
+    default:
+        break;
+    }
+    if (seconds <= 1 || fratricideP <= 0)
+        return fratricideP;
+    // probability that the cell is destroyed in at least one of the seconds
+    return -expm1(seconds * log1p(-fratricideP));
+}
+
+void CarTCell::RegisterKill(ParticleType type) {
+    switch (type) {
+    case CancerCellType:
+        m_killedCancerCells += 1;
+        break;
+    case TCellType:
+        m_killedTCells += 1;
+        break;
+    case CarTCellType:
+        m_killedCarTCells += 1;
+        break;
+    default:
+        return;
+    }
+    m_isActive = true;
+}
+
 bool CarTCell::IsActive() { return IsAlive() && m_isActive; }
 
 bool CarTCell::HasDetectedTCells() { return m_detectedTCells > 0; }
@@ -87,17 +125,19 @@ bool CarTCell::HasKilledTCells() { return m_killedTCells > 0; }
 
 int CarTCell::GetNumberOfKilledTCells() { return m_killedTCells; }
 
-int CarTCell::KillSomeTCells(int numberCells) {
+int CarTCell::KillSomeTCells(int numberCells, int vessel) {
+    KeyedRandom random(GlobalTimer::GetStep(), vessel, GetParticleID(),
+                       KeyedRandom::BatchKillPurpose, TCellType);
     int killedCells = 0;
     for (int i = 0; i < numberCells; i++)
-        killedCells += int(KillTCell());
+        killedCells += int(KillTCell(random.GetValue()));
     return killedCells;
 }
 
-bool CarTCell::KillTCell() {
+bool CarTCell::KillTCell(double randomValue, int seconds) {
     if (!IsAlive())
         return false;
-    bool killIt = Randomizer::GetRandomValue() < m_tFratricideP;
+    bool killIt = randomValue < GetFratricideP(TCellType, seconds);
     if (killIt == true) {
         m_killedTCells += 1;
         m_isActive = true;
@@ -118,17 +158,19 @@ bool CarTCell::HasKilledCancerCells() { return m_killedCancerCells > 0; }
 
 int CarTCell::GetNumberOfKilledCancerCells() { return m_killedCancerCells; }
 
-int CarTCell::KillSomeCancerCells(int numberCells) {
+int CarTCell::KillSomeCancerCells(int numberCells, int vessel) {
+    KeyedRandom random(GlobalTimer::GetStep(), vessel, GetParticleID(),
+                       KeyedRandom::BatchKillPurpose, CancerCellType);
     int killedCells = 0;
     for (int i = 0; i < numberCells; i++)
-        killedCells += int(KillCancerCell());
+        killedCells += int(KillCancerCell(random.GetValue()));
     return killedCells;
 }
 
-bool CarTCell::KillCancerCell() {
+bool CarTCell::KillCancerCell(double randomValue, int seconds) {
     if (!IsAlive())
         return false;
-    bool killIt = Randomizer::GetRandomValue() < m_cancerFratricideP;
+    bool killIt = randomValue < GetFratricideP(CancerCellType, seconds);
     if (killIt == true) {
         m_killedCancerCells += 1;
         m_isActive = true;
@@ -149,17 +191,19 @@ bool CarTCell::HasKilledCarTCells() { return m_killedCarTCells > 0; }
 
 int CarTCell::GetNumberOfKilledCarTCells() { return m_killedCarTCells; }
 
-int CarTCell::KillSomeCarTCells(int numberCells) {
+int CarTCell::KillSomeCarTCells(int numberCells, int vessel) {
+    KeyedRandom random(GlobalTimer::GetStep(), vessel, GetParticleID(),
+                       KeyedRandom::BatchKillPurpose, CarTCellType);
     int killedCells = 0;
     for (int i = 0; i < numberCells; i++)
-        killedCells += int(KillCarTCell());
+        killedCells += int(KillCarTCell(random.GetValue()));
     return killedCells;
 }
 
-bool CarTCell::KillCarTCell() {
+bool CarTCell::KillCarTCell(double randomValue, int seconds) {
     if (!IsAlive())
         return false;
-    bool killIt = Randomizer::GetRandomValue() < m_carTFratricideP;
+    bool killIt = randomValue < GetFratricideP(CarTCellType, seconds);
     if (killIt == true) {
         m_killedCarTCells += 1;
         m_isActive = true;
@@ -167,7 +211,7 @@ bool CarTCell::KillCarTCell() {
     return killIt;
 }
 
-bool CarTCell::AddPossibleMitosis(ParticleType type) {
+double CarTCell::GetMitosisP(ParticleType type) {
     double mitosisP = 0;
     switch(type) {
         case CarTCellType:
@@ -182,11 +226,22 @@ bool CarTCell::AddPossibleMitosis(ParticleType type) {
         default:
             break;
     } 
-    m_willPerformMitosis = m_willPerformMitosis ||
-        Randomizer::GetRandomValue() < mitosisP;
+    return mitosisP;
+}
+
+bool CarTCell::AddPossibleMitosis(ParticleType type, size_t count,
+                                  double randomValue) {
+    double mitosisP = GetMitosisP(type);
+    if (count == 0 || mitosisP <= 0)
+        return m_willPerformMitosis;
+    // probability that at least one of count encounters leads to mitosis
+    double anyMitosisP = -expm1(count * log1p(-mitosisP));
+    m_willPerformMitosis = m_willPerformMitosis || randomValue < anyMitosisP;
     return m_willPerformMitosis;
 }
 
+void CarTCell::SetWillPerformMitosis() { m_willPerformMitosis = true; }
+
 bool CarTCell::WillPerformMitosis() {
     return m_willPerformMitosis;
 }
@@ -194,4 +249,40 @@ bool CarTCell::WillPerformMitosis() {
 void CarTCell::ResetMitosis() {
     m_willPerformMitosis = false;
 }
+
+void CarTCell::SaveState(ostream &out) {
+    Particle::SaveState(out);
+    WriteState(out, m_delay);
+    WriteState(out, m_cancerFratricideP);
+    WriteState(out, m_tFratricideP);
+    WriteState(out, m_carTFratricideP);
+    WriteState(out, m_cancerMitosisP);
+    WriteState(out, m_tMitosisP);
+    WriteState(out, m_carTMitosisP);
+    WriteState(out, m_isActive);
+    WriteState(out, m_detectedCancerCells);
+    WriteState(out, m_killedCancerCells);
+    WriteState(out, m_detectedTCells);
+    WriteState(out, m_killedTCells);
+    WriteState(out, m_detectedCarTCells);
+    WriteState(out, m_killedCarTCells);
+}
+
+void CarTCell::LoadState(istream &in) {
+    Particle::LoadState(in);
+    ReadState(in, m_delay);
+    ReadState(in, m_cancerFratricideP);
+    ReadState(in, m_tFratricideP);
+    ReadState(in, m_carTFratricideP);
+    ReadState(in, m_cancerMitosisP);
+    ReadState(in, m_tMitosisP);
+    ReadState(in, m_carTMitosisP);
+    ReadState(in, m_isActive);
+    ReadState(in, m_detectedCancerCells);
+    ReadState(in, m_killedCancerCells);
+    ReadState(in, m_detectedTCells);
+    ReadState(in, m_killedTCells);
+    ReadState(in, m_detectedCarTCells);
+    ReadState(in, m_killedCarTCells);
+}
 } // namespace particles
@@ -31,7 +31,7 @@ class CarTCell;
  * \brief CarTCell is a mobile object that detects CancerCells.
  */
 
-class CarTCell : public Particle {
+class CarTCell final : public Particle {
 private:
     double m_delay;             // factor for changed traveling speed
     double m_cancerFratricideP; // probability in [0,1] that describes how
@@ -72,6 +72,28 @@ public:
 
     double GetCarTFratricideP();
 
+    /**
+     * \returns the probability that one encounter with a cell of the given
+     * type leads to its destruction.
+     * \param seconds the encounter lasts, the probability applies per second.
+     */
+    double GetFratricideP(ParticleType type, int seconds = 1);
+
+    /**
+     * \returns the probability that one encounter with a cell of the given
+     * type leads to the mitosis of the CarTCell.
+     */
+    double GetMitosisP(ParticleType type);
+
+    /**
+     * Records the kill of a cell of the given type that was already decided,
+     * e.g. by the batch sampling of the interactions.
+     */
+    void RegisterKill(ParticleType type);
+
+    /// The CarTCell performs mitosis in the next step.
+    void SetWillPerformMitosis();
+
     bool IsActive();
 
     bool HasDetectedTCells();
@@ -84,9 +106,17 @@ public:
 
     int GetNumberOfKilledTCells();
 
-    int KillSomeTCells(int numberCells);
+    /**
+     * Draws the kill of each of numberCells encountered TCells.
+     * \param numberCells number of encountered TCells.
+     * \param vessel ID of the vessel of the encounters, keys the draws.
+     * \returns the number of killed TCells.
+     */
+    int KillSomeTCells(int numberCells, int vessel);
 
-    bool KillTCell();
+    /// \param randomValue in [0,1), kills the TCell if below the probability.
+    /// \param seconds the encounter lasts.
+    bool KillTCell(double randomValue, int seconds = 1);
 
     bool HasDetectedCancerCells();
 
@@ -98,9 +128,18 @@ public:
 
     int GetNumberOfKilledCancerCells();
 
-    int KillSomeCancerCells(int numberCells);
+    /**
+     * Draws the kill of each of numberCells encountered CancerCells.
+     * \param numberCells number of encountered CancerCells.
+     * \param vessel ID of the vessel of the encounters, keys the draws.
+     * \returns the number of killed CancerCells.
+     */
+    int KillSomeCancerCells(int numberCells, int vessel);
 
-    bool KillCancerCell();
+    /// \param randomValue in [0,1), kills the CancerCell if below the
+    /// probability.
+    /// \param seconds the encounter lasts.
+    bool KillCancerCell(double randomValue, int seconds = 1);
 
     bool HasDetectedCarTCells();
 
@@ -112,11 +151,28 @@ public:
 
     int GetNumberOfKilledCarTCells();
 
-    int KillSomeCarTCells(int numberCells);
-
-    bool KillCarTCell();
-
-    bool AddPossibleMitosis(ParticleType type) override;
+    /**
+     * Draws the kill of each of numberCells encountered CarTCells.
+     * \param numberCells number of encountered CarTCells.
+     * \param vessel ID of the vessel of the encounters, keys the draws.
+     * \returns the number of killed CarTCells.
+     */
+    int KillSomeCarTCells(int numberCells, int vessel);
+
+    /// \param randomValue in [0,1), kills the CarTCell if below the
+    /// probability.
+    /// \param seconds the encounter lasts.
+    bool KillCarTCell(double randomValue, int seconds = 1);
+
+    /**
+     * Draws whether count encounters lead to the mitosis of the CarTCell,
+     * with a single random draw.
+     * \param type of the encountered cells.
+     * \param count number of encountered cells.
+     * \param randomValue in [0,1) used for the draw.
+     */
+    bool AddPossibleMitosis(ParticleType type, size_t count,
+                            double randomValue);
 
     bool WillPerformMitosis() override;
 
@@ -127,6 +183,10 @@ public:
         int m_injectionVessel;
         int m_injectionNumber;
     };
+
+    void SaveState(ostream &out) override;
+
+    void LoadState(istream &in) override;
 };
 }; // namespace particles
 #endif
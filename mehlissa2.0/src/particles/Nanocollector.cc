@@ -47,4 +47,18 @@ bool Nanocollector::HasTissueDetected() { return m_tissueDetected; }
 
 void Nanocollector::collectMessage() { this->m_tissueDetected = true; }
 
+void Nanocollector::SaveState(ostream &out) {
+    Particle::SaveState(out);
+    WriteState(out, m_delay);
+    WriteState(out, m_targetOrgan);
+    WriteState(out, m_tissueDetected);
+}
+
+void Nanocollector::LoadState(istream &in) {
+    Particle::LoadState(in);
+    ReadState(in, m_delay);
+    ReadState(in, m_targetOrgan);
+    ReadState(in, m_tissueDetected);
+}
+
 } // namespace particles
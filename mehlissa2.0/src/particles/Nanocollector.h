@@ -33,7 +33,7 @@ class Nanocollector;
  * check the last column. False (0) is a Particle and true (1) a Nanocollector.
  */
 
-class Nanocollector : public Particle {
+class Nanocollector final : public Particle {
 private:
     double m_delay;        // factor for slower traveling speed.
     int m_targetOrgan;     // Marker for Organ whos message molecule can be
@@ -85,6 +85,10 @@ public:
      * This method is used to collect a message.
      */
     void collectMessage();
+
+    void SaveState(ostream &out) override;
+
+    void LoadState(istream &in) override;
 };
 }; // namespace particles
 #endif
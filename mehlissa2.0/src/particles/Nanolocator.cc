@@ -41,4 +41,16 @@ void NanoLocator::releaseFingerprintTiles() {
     std::cout << "Tiles released" << std::endl;
 }
 
+void NanoLocator::SaveState(ostream &out) {
+    Particle::SaveState(out);
+    WriteState(out, m_hasFingerprint);
+    WriteState(out, m_targetOrgan);
+}
+
+void NanoLocator::LoadState(istream &in) {
+    Particle::LoadState(in);
+    ReadState(in, m_hasFingerprint);
+    ReadState(in, m_targetOrgan);
+}
+
 } // namespace particles
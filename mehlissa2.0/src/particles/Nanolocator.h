@@ -36,7 +36,7 @@ class NanoLocator;
  * able to detect.
  */
 
-class NanoLocator : public Particle {
+class NanoLocator final : public Particle {
 private:
     bool m_hasFingerprint; // has fingerprint loaded in the beginning, after
                            // release false
@@ -77,6 +77,10 @@ public:
      * This function releases fingerprint tiles.
      */
     void releaseFingerprintTiles();
+
+    void SaveState(ostream &out) override;
+
+    void LoadState(istream &in) override;
 };
 }; // namespace particles
 #endif
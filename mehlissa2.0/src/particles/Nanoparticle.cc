@@ -52,4 +52,18 @@ namespace particles {
 
     void Nanoparticle::GetsDetected() { this->m_got_detected++; }
 
+    void Nanoparticle::SaveState(ostream &out) {
+        Particle::SaveState(out);
+        WriteState(out, m_delay);
+        WriteState(out, m_got_detected);
+        WriteState(out, m_detectionRadius);
+    }
+
+    void Nanoparticle::LoadState(istream &in) {
+        Particle::LoadState(in);
+        ReadState(in, m_delay);
+        ReadState(in, m_got_detected);
+        ReadState(in, m_detectionRadius);
+    }
+
 } // namespace particles
@@ -71,11 +71,15 @@ public:
      * Setter method for detection status.
      * This method is used to signal a detection.
      */
-    void GetsDetected();
+    void GetsDetected() final;
 
     double GetDetectionRadius();
 
     void SetDetectionRadius(double value);
+
+    void SaveState(ostream &out) override;
+
+    void LoadState(istream &in) override;
 };
 }; // namespace particles
 #endif
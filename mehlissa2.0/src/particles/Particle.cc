@@ -29,6 +29,7 @@ Particle::Particle() {
     m_length = 0.00001; // 100nm
     m_width = 0.00001;  // 100nm
     m_stream_nb = 0;
+    m_arcLength = 0;
     m_shouldChange = false;
     m_timeStep = 0;
 
@@ -42,7 +43,8 @@ Particle::Particle() {
 
 Particle::~Particle() {}
 
-bool Particle::Compare(shared_ptr<Particle> v1, shared_ptr<Particle> v2) {
+bool Particle::Compare(const shared_ptr<Particle> &v1,
+                       const shared_ptr<Particle> &v2) {
     if (v1->GetParticleID() < v2->GetParticleID())
         return true;
     else
@@ -81,6 +83,8 @@ uint64_t Particle::GetTimeStepInSeconds() { return m_timeStep; }
 
 void Particle::SetTimeStep() { m_timeStep = GlobalTimer::NowInSeconds(); } // TODO
 
+void Particle::SetTimeStep(uint64_t timeStep) { m_timeStep = timeStep; }
+
 Position Particle::GetPosition() {
     return m_position;
 }
@@ -91,6 +95,10 @@ void Particle::SetPosition(Position value) {
     m_position.z = value.z;
 }
 
+double Particle::GetArcLength() { return m_arcLength; }
+
+void Particle::SetArcLength(double value) { m_arcLength = value; }
+
 double Particle::GetDelay() { return 1; }
 
 int Particle::GetTargetOrgan() { return 0; }
@@ -136,7 +144,11 @@ bool Particle::Age(int secCount) {
         m_mitosisCounter -= secCount;
     if (!m_canAge)
         return true;
-    m_ageCounter -= secCount;
+    // the counter is unsigned, several seconds may pass the end of the life
+    if (m_ageCounter <= (uint64_t)secCount)
+        m_ageCounter = 0;
+    else
+        m_ageCounter -= secCount;
     return m_ageCounter > 0;
 }
 
@@ -153,4 +165,42 @@ void Particle::ResetMitosis() {
         m_mitosisCounter = m_mitosisTime;
     return;
 }
+
+void Particle::SaveState(ostream &out) {
+    WriteState(out, m_nanobotID);
+    WriteState(out, m_length);
+    WriteState(out, m_width);
+    WriteState(out, m_stream_nb);
+    WriteState(out, m_position.x);
+    WriteState(out, m_position.y);
+    WriteState(out, m_position.z);
+    WriteState(out, m_arcLength);
+    WriteState(out, m_canAge);
+    WriteState(out, m_maxAge);
+    WriteState(out, m_ageCounter);
+    WriteState(out, m_shouldChange);
+    WriteState(out, m_timeStep);
+    WriteState(out, m_willPerformMitosis);
+    WriteState(out, m_mitosisTime);
+    WriteState(out, m_mitosisCounter);
+}
+
+void Particle::LoadState(istream &in) {
+    ReadState(in, m_nanobotID);
+    ReadState(in, m_length);
+    ReadState(in, m_width);
+    ReadState(in, m_stream_nb);
+    ReadState(in, m_position.x);
+    ReadState(in, m_position.y);
+    ReadState(in, m_position.z);
+    ReadState(in, m_arcLength);
+    ReadState(in, m_canAge);
+    ReadState(in, m_maxAge);
+    ReadState(in, m_ageCounter);
+    ReadState(in, m_shouldChange);
+    ReadState(in, m_timeStep);
+    ReadState(in, m_willPerformMitosis);
+    ReadState(in, m_mitosisTime);
+    ReadState(in, m_mitosisCounter);
+}
 } // namespace particles
@@ -22,6 +22,7 @@
 
 #include "../utils/GlobalTimer.h"
 #include "../utils/Position.h"
+#include "../utils/StateIO.h"
 #include <list>
 #include <memory>
 #include <cstdint>
@@ -62,6 +63,7 @@ protected:
     int m_stream_nb; // nanobot's stream.
 
     Position m_position;   // nanobot's position
+    double m_arcLength;    // distance along the axis of its stream
 
     bool m_canAge;         // nanobot can age and die
     uint64_t m_maxAge;     // nanobot's maximum age [s]
@@ -88,7 +90,8 @@ public:
 
     /// Compare is used for the purpose of sorting nanobots based on their ID in
     /// a list or a queue. returns true if the ID of v1 is smaller than v2's ID.
-    static bool Compare(shared_ptr<Particle> v1, shared_ptr<Particle> v2);
+    static bool Compare(const shared_ptr<Particle> &v1,
+                        const shared_ptr<Particle> &v2);
 
     /// Getter and setter methods
 
@@ -154,6 +157,11 @@ public:
      */
     void SetTimeStep();
 
+    /**
+     * \param timeStep the time of the last change in position.
+     */
+    void SetTimeStep(uint64_t timeStep);
+
     /**
      * \returns the position of Particle's Node which is located at the center
      * back of the Particle.
@@ -169,6 +177,17 @@ public:
      */
     void SetPosition(Position value);
 
+    /**
+     * \returns the distance of the Particle along the axis of its stream,
+     * measured from the start of the vessel.
+     */
+    double GetArcLength();
+
+    /**
+     * \param value distance along the axis of the stream.
+     */
+    void SetArcLength(double value);
+
     /**
      * \returns the delay if set in child (eg. Nanocollector).
      */
@@ -237,6 +256,13 @@ public:
     virtual bool AddPossibleMitosis(ParticleType type);
     
     virtual bool WillPerformMitosis();
+
+    /// Writes the fields of the Particle for a checkpoint, the subclasses
+    /// add their own.
+    virtual void SaveState(ostream &out);
+
+    /// Reads the fields written by SaveState().
+    virtual void LoadState(istream &in);
 };
 }; // namespace particles
 #endif
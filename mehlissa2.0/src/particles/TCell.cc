@@ -37,4 +37,18 @@ int TCell::WasDetected() { return m_got_detected > 0; }
 
 void TCell::SetDelay(double value) {}
 
+void TCell::SaveState(ostream &out) {
+    Nanoparticle::SaveState(out);
+    WriteState(out, m_delay);
+    WriteState(out, m_got_detected);
+    WriteState(out, m_detectionRadius);
+}
+
+void TCell::LoadState(istream &in) {
+    Nanoparticle::LoadState(in);
+    ReadState(in, m_delay);
+    ReadState(in, m_got_detected);
+    ReadState(in, m_detectionRadius);
+}
+
 } // namespace particles
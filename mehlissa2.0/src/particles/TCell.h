@@ -30,7 +30,7 @@ class TCell;
 /**
  * \brief CarTCell is a mobile object that detects CancerCells.
  */
-class TCell : public Nanoparticle {
+class TCell final : public Nanoparticle {
 private:
     double m_delay;     // factor for changed travelling  speed
     int m_got_detected; // counts up if particle was detected by nanobot
@@ -48,6 +48,10 @@ public:
      * Only the delay calculated in the constructor is used.
      */
     void SetDelay(double value);
+
+    void SaveState(ostream &out) override;
+
+    void LoadState(istream &in) override;
 };
 }; // namespace particles
 #endif
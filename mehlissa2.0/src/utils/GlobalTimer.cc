@@ -22,20 +22,32 @@
 namespace utils {
 
 static uint64_t m_time; // in seconds, so basically unixtime as simulationtime
+static uint64_t m_step; // number of steps
 
 GlobalTimer::GlobalTimer() {}
 GlobalTimer::~GlobalTimer() {}
 
 void GlobalTimer::ResetTimer() {
     m_time = 0;
+    m_step = 0;
 }
 
 void GlobalTimer::IncreaseTimer(double step) {
     m_time += (step * 1000);
+    m_step++;
 }
 
 double GlobalTimer::NowInSeconds() {
     return m_time/1000;
 }
+
+uint64_t GlobalTimer::GetStep() { return m_step; }
+
+uint64_t GlobalTimer::GetTimeInMS() { return m_time; }
+
+void GlobalTimer::SetTimer(uint64_t timeInMS, uint64_t step) {
+    m_time = timeInMS;
+    m_step = step;
+}
 } // namespace utils
 
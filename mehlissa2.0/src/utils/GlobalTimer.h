@@ -35,6 +35,15 @@ public:
     static void IncreaseTimer(double step);
 
     static double NowInSeconds();
+
+    // Will return the number of steps since the last reset.
+    static uint64_t GetStep();
+
+    // Will return the time in milliseconds, for checkpoints.
+    static uint64_t GetTimeInMS();
+
+    // Restores the time and step of a checkpoint.
+    static void SetTimer(uint64_t timeInMS, uint64_t step);
 };
 }; // namespace utils
 #endif
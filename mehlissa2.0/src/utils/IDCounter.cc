@@ -20,15 +20,20 @@
 #include "IDCounter.h"
 
 namespace utils {
-static unsigned int m_nextParticleID = 0;
+// atomic, as new cells are created concurrently in parallel vessel steps
+static atomic<unsigned int> m_nextParticleID = 0;
 
 void IDCounter::InitIDCounter() {
     m_nextParticleID = 0;
 }
 
 unsigned int IDCounter::GetNextParticleID() {
-    unsigned int ID = m_nextParticleID;
-    m_nextParticleID++;
-    return ID; 
+    return m_nextParticleID.fetch_add(1);
+}
+
+unsigned int IDCounter::PeekNextParticleID() { return m_nextParticleID; }
+
+void IDCounter::SetNextParticleID(unsigned int value) {
+    m_nextParticleID = value;
 }
 } // namespace utils
@@ -20,6 +20,8 @@
 #ifndef H_IDCOUNTER_
 #define H_IDCOUNTER_
 
+#include <atomic>
+
 using namespace std;
 
 namespace utils {
@@ -29,6 +31,12 @@ public:
 
     // will return the next unique nanobot ID
     static unsigned int GetNextParticleID();
+
+    // will return the next ID without using it, for checkpoints
+    static unsigned int PeekNextParticleID();
+
+    // continues the IDs of a checkpoint
+    static void SetNextParticleID(unsigned int value);
 };
 }; // namespace utils
 #endif
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "KeyedRandom.h"
+#include "Randomizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace utils {
+
+// below this mean the binomial draw uses the inversion
+const double BinomialInversionLimit = 30;
+
+KeyedRandom::KeyedRandom(uint64_t step, int vessel, unsigned int particleID,
+                         Purpose purpose, uint32_t subKey) {
+    m_counter[0] = (uint32_t)step;
+    m_counter[1] = ((uint32_t)vessel << 8) | (purpose & 0xFF);
+    m_counter[2] = particleID;
+    m_counter[3] = 0;
+    m_key[0] = Randomizer::GetSeed();
+    m_key[1] = subKey;
+    m_used = 4;
+}
+
+KeyedRandom::~KeyedRandom() {}
+
+void KeyedRandom::Philox(const uint32_t counter[4], const uint32_t key[2],
+                         uint32_t out[4]) {
+    const uint32_t M0 = 0xD2511F53;
+    const uint32_t M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9;
+    const uint32_t W1 = 0xBB67AE85;
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2],
+             c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = (uint64_t)M0 * c0;
+        uint64_t p1 = (uint64_t)M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n1 = (uint32_t)p1;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        uint32_t n3 = (uint32_t)p0;
+        c0 = n0;
+        c1 = n1;
+        c2 = n2;
+        c3 = n3;
+        k0 += W0;
+        k1 += W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+void KeyedRandom::NextBlock() {
+    Philox(m_counter, m_key, m_block);
+    m_counter[3]++;
+    m_used = 0;
+}
+
+KeyedRandom::result_type KeyedRandom::operator()() {
+    if (m_used >= 4)
+        NextBlock();
+    return m_block[m_used++];
+}
+
+double KeyedRandom::GetValue() {
+    // 53 random bits
+    uint64_t high = (*this)() >> 5;
+    uint64_t low = (*this)() >> 6;
+    return (high * 67108864.0 + low) / 9007199254740992.0;
+}
+
+double KeyedRandom::GetValue(double min, double max) {
+    return min + GetValue() * (max - min);
+}
+
+bool KeyedRandom::GetBoolean() { return GetValue() >= 0.5; }
+
+int KeyedRandom::GetIntegerValue(int min, int max) {
+    return min + (int)floor(GetValue() * ((double)max - min + 1));
+}
+
+// Binomial draw by inversion, for n * p < BinomialInversionLimit and
+// p <= 0.5.
+static uint64_t BinomialInversion(KeyedRandom &random, uint64_t trials,
+                                  double p) {
+    double n = trials;
+    double q = 1 - p;
+    double qn = exp(n * log1p(-p));
+    double np = n * p;
+    // restart far in the tail, where the sum of rounding errors dominates
+    double bound = min(n, np + 10 * sqrt(np * q + 1));
+    uint64_t x = 0;
+    double px = qn;
+    double u = random.GetValue();
+    while (u > px) {
+        x++;
+        if (x > bound) {
+            x = 0;
+            px = qn;
+            u = random.GetValue();
+        } else {
+            u -= px;
+            px = ((n - x + 1) * p * px) / (x * q);
+        }
+    }
+    return x;
+}
+
+// Binomial draw by BTPE (Kachitvichyanukul and Schmeiser, 1988), for
+// n * p >= BinomialInversionLimit and p <= 0.5.
+static uint64_t BinomialBtpe(KeyedRandom &random, uint64_t trials, double p) {
+    double n = trials;
+    double q = 1 - p;
+    double nrq = n * p * q;
+    double fm = n * p + p;
+    double m = floor(fm);
+    // the triangle, parallelograms and exponential tails of the hat
+    double p1 = floor(2.195 * sqrt(nrq) - 4.6 * q) + 0.5;
+    double xm = m + 0.5;
+    double xl = xm - p1;
+    double xr = xm + p1;
+    double c = 0.134 + 20.5 / (15.3 + m);
+    double a = (fm - xl) / (fm - xl * p);
+    double laml = a * (1 + a / 2);
+    a = (xr - fm) / (xr * q);
+    double lamr = a * (1 + a / 2);
+    double p2 = p1 * (1 + 2 * c);
+    double p3 = p2 + c / laml;
+    double p4 = p3 + c / lamr;
+    while (true) {
+        double u = random.GetValue() * p4;
+        double v = random.GetValue();
+        double y;
+        if (u <= p1)
+            return (uint64_t)floor(xm - p1 * v + u);
+        if (u <= p2) {
+            double x = xl + (u - p1) / c;
+            v = v * c + 1 - fabs(m - x + 0.5) / p1;
+            if (v > 1)
+                continue;
+            y = floor(x);
+        } else if (u <= p3) {
+            y = floor(xl + log(v) / laml);
+            if (y < 0 || v == 0)
+                continue;
+            v = v * (u - p2) * laml;
+        } else {
+            y = floor(xr - log(v) / lamr);
+            if (y > n || v == 0)
+                continue;
+            v = v * (u - p3) * lamr;
+        }
+        double k = fabs(y - m);
+        if (k <= 20 || k >= nrq / 2 - 1) {
+            // f(y) / f(m) evaluated by the recursion of the probabilities
+            double s = p / q;
+            double as = s * (n + 1);
+            double f = 1;
+            if (m < y) {
+                for (double i = m + 1; i <= y; i++)
+                    f *= as / i - s;
+            } else if (m > y) {
+                for (double i = y + 1; i <= m; i++)
+                    f /= as / i - s;
+            }
+            if (v <= f)
+                return (uint64_t)y;
+            continue;
+        }
+        // squeeze of log(f(y) / f(m)), then the bound by Stirling's formula
+        double rho = (k / nrq) *
+                     ((k * (k / 3 + 0.625) + 0.1666666666666667) / nrq + 0.5);
+        double t = -k * k / (2 * nrq);
+        double logV = log(v);
+        if (logV < t - rho)
+            return (uint64_t)y;
+        if (logV > t + rho)
+            continue;
+        double x1 = y + 1;
+        double f1 = m + 1;
+        double z = n + 1 - m;
+        double w = n - y + 1;
+        double x2 = x1 * x1;
+        double f2 = f1 * f1;
+        double z2 = z * z;
+        double w2 = w * w;
+        double bound =
+            xm * log(f1 / x1) + (n - m + 0.5) * log(z / w) +
+            (y - m) * log(w * p / (x1 * q)) +
+            (13860 - (462 - (132 - (99 - 140 / f2) / f2) / f2) / f2) / f1 /
+                166320 +
+            (13860 - (462 - (132 - (99 - 140 / z2) / z2) / z2) / z2) / z /
+                166320 +
+            (13860 - (462 - (132 - (99 - 140 / x2) / x2) / x2) / x2) / x1 /
+                166320 +
+            (13860 - (462 - (132 - (99 - 140 / w2) / w2) / w2) / w2) / w /
+                166320;
+        if (logV <= bound)
+            return (uint64_t)y;
+    }
+}
+
+uint64_t KeyedRandom::GetBinomialValue(uint64_t trials, double p) {
+    if (trials == 0 || p <= 0)
+        return 0;
+    if (p >= 1)
+        return trials;
+    // both samplers draw for p <= 0.5, the rest by symmetry
+    double r = std::min(p, 1 - p);
+    uint64_t successes = trials * r < BinomialInversionLimit
+                             ? BinomialInversion(*this, trials, r)
+                             : BinomialBtpe(*this, trials, r);
+    return p > 0.5 ? trials - successes : successes;
+}
+} // namespace utils
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_KEYEDRANDOM_
+#define CLASS_KEYEDRANDOM_
+
+#include <cstdint>
+#include <limits>
+
+using namespace std;
+
+namespace utils {
+/**
+ * \brief KeyedRandom draws random values with the counter based generator
+ * Philox4x32-10.
+ *
+ * Every value is a pure function of the global seed and the key (step,
+ * vessel, particle, purpose, sub key) plus the number of values drawn from
+ * the same key before. There is no shared state, so the results do not
+ * depend on the number of threads or on the order in which the vessels are
+ * stepped. KeyedRandom is a UniformRandomBitGenerator and can be used with
+ * the distributions of <random>.
+ */
+class KeyedRandom {
+public:
+    // What a draw is used for, keeps the draws of one particle in one step
+    // independent of each other.
+    enum Purpose : uint32_t {
+        MovementPurpose = 1,       // velocity offset and direction
+        StreamChangePurpose,       // particle changes its stream
+        StreamDirectionPurpose,    // direction of the stream change
+        TransitionPurpose,         // next vessel at a bifurcation
+        KillPurpose,               // CarTCell kills another cell
+        MitosisPurpose,            // CarTCell performs mitosis
+        BatchKillPurpose,          // batch sampled kills of a vessel
+        BatchMitosisPurpose,       // batch sampled mitoses of a vessel
+        InjectionPurpose,          // stream of injected particles
+        ResidenceTablePurpose,     // sampled passage of a residence table
+        ResidencePurpose,          // residence time of a particle in a vessel
+        ExchangePurpose            // stream of an exchanged particle
+    };
+
+    typedef uint32_t result_type;
+
+private:
+    uint32_t m_counter[4]; // step, vessel and purpose, particle, block
+    uint32_t m_key[2];     // seed, sub key
+    uint32_t m_block[4];   // output of the current block
+    int m_used;            // words used of m_block
+
+    void NextBlock();
+
+public:
+    /**
+     * \param step number of the simulation step.
+     * \param vessel ID of the vessel that draws.
+     * \param particleID ID of the particle the draw belongs to, 0 if none.
+     * \param purpose of the draws.
+     * \param subKey distinguishes draws with the same key, e.g. the target
+     * of a CarTCell.
+     */
+    KeyedRandom(uint64_t step, int vessel, unsigned int particleID,
+                Purpose purpose, uint32_t subKey = 0);
+
+    ~KeyedRandom();
+
+    /// Philox4x32-10 applied to counter with key, writes 4 words to out.
+    static void Philox(const uint32_t counter[4], const uint32_t key[2],
+                       uint32_t out[4]);
+
+    // Will return a random value in [0,1).
+    double GetValue();
+
+    // Will return a random value in [min,max).
+    double GetValue(double min, double max);
+
+    // Will return either true or false randomly.
+    bool GetBoolean();
+
+    // Will return a random integer in [min,max].
+    int GetIntegerValue(int min, int max);
+
+    // Will return the number of successes in trials Bernoulli trials with
+    // probability p. Drawn by inversion for a small mean and by BTPE
+    // otherwise, so the value does not depend on the standard library.
+    uint64_t GetBinomialValue(uint64_t trials, double p);
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() {
+        return numeric_limits<result_type>::max();
+    }
+
+    result_type operator()();
+};
+}; // namespace utils
+#endif
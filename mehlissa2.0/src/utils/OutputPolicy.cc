@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "OutputPolicy.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace utils {
+
+OutputPolicy::OutputPolicy() {
+    m_everyKSteps = 1;
+    m_sampleRate = 1;
+    m_typeMask = ~0u;
+}
+
+OutputPolicy::~OutputPolicy() {}
+
+void OutputPolicy::SetEveryKSteps(int k) {
+    if (k < 1)
+        throw runtime_error("Output interval must be at least 1 step. Given: " +
+                            to_string(k));
+    m_everyKSteps = k;
+}
+
+void OutputPolicy::SetIDs(string ids) {
+    m_ids.clear();
+    stringstream list(ids);
+    string id;
+    while (getline(list, id, ','))
+        if (id != "")
+            m_ids.insert(stoul(id));
+}
+
+void OutputPolicy::SetSampleRate(double rate) {
+    if (rate < 0 || rate > 1)
+        throw runtime_error("Output sample rate must be in [0,1]. Given: " +
+                            to_string(rate));
+    m_sampleRate = rate;
+}
+
+void OutputPolicy::SetTypes(string types) {
+    const string names[] = {"Particle",     "Nanocollector", "Nanolocator",
+                            "Nanoparticle", "CancerCell",    "CarTCell",
+                            "TCell",        "ContainerParticle",
+                            "SwitchableParticle"};
+    if (types == "") {
+        m_typeMask = ~0u;
+        return;
+    }
+    m_typeMask = 0;
+    stringstream list(types);
+    string type;
+    while (getline(list, type, ',')) {
+        int number = -1;
+        for (int i = 0; i <= SwitchableParticleType; i++)
+            if (type == names[i] || type == to_string(i))
+                number = i;
+        if (number < 0)
+            throw runtime_error("Unknown particle type: " + type);
+        m_typeMask |= 1u << number;
+    }
+}
+
+bool OutputPolicy::RecordsParticle(unsigned int id, ParticleType type) {
+    if (!(m_typeMask & (1u << type)))
+        return false;
+    if (m_ids.empty() && m_sampleRate >= 1)
+        return true;
+    if (m_ids.count(id) > 0)
+        return true;
+    if (m_sampleRate >= 1)
+        return false;
+    // splitmix64 finalizer, maps the ID to a uniform value in [0,1)
+    uint64_t h = id + 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h = h ^ (h >> 31);
+    return (h >> 11) * (1.0 / 9007199254740992.0) < m_sampleRate;
+}
+} // namespace utils
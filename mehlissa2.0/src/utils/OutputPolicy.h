@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_OUTPUTPOLICY_
+#define CLASS_OUTPUTPOLICY_
+
+#include "../particles/Particle.h"
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+using namespace std;
+using namespace particles;
+
+namespace utils {
+/**
+ * \brief OutputPolicy decides which steps and which Particles are written to
+ * the particle output.
+ *
+ * A step is recorded if it is a multiple of the output interval. A Particle
+ * is recorded if its type is selected and, if IDs are restricted by a list or
+ * a sample rate below 1, its ID is listed or sampled. The sampling hashes the
+ * ID, so a sampled Particle is recorded in every recorded step. The gateway
+ * output is not filtered.
+ */
+class OutputPolicy {
+private:
+    uint64_t m_everyKSteps;
+    unordered_set<unsigned int> m_ids; // explicitly listed IDs
+    double m_sampleRate;               // fraction of IDs sampled
+    uint32_t m_typeMask;               // bit per selected ParticleType
+
+public:
+    OutputPolicy();
+    ~OutputPolicy();
+
+    /**
+     * \param k only every k-th step is recorded.
+     */
+    void SetEveryKSteps(int k);
+
+    /**
+     * \param ids comma separated list of recorded particle IDs, empty for
+     * no list.
+     */
+    void SetIDs(string ids);
+
+    /**
+     * \param rate fraction in [0,1] of the particle IDs that are recorded,
+     * 1 records all.
+     */
+    void SetSampleRate(double rate);
+
+    /**
+     * \param types comma separated list of ParticleTypes by name (e.g.
+     * "CancerCell,CarTCell") or number, empty for all types.
+     */
+    void SetTypes(string types);
+
+    /// \returns true if the Particles are written in the given step.
+    bool RecordsStep(uint64_t step) { return step % m_everyKSteps == 0; }
+
+    /// \returns true if the Particle with the given ID and type is written.
+    bool RecordsParticle(unsigned int id, ParticleType type);
+};
+}; // namespace utils
+#endif
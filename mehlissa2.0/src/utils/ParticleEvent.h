@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_PARTICLEEVENT_
+#define CLASS_PARTICLEEVENT_
+
+#include <cstdint>
+
+namespace utils {
+/**
+ * Kinds of events written by the event output. Within a vessel a Particle
+ * moves deterministically, so its positions are rebuilt from these events.
+ */
+enum ParticleEventKind {
+    EntryEvent,        // entered a vessel, or was placed in it at the start
+    ExitEvent,         // reached the end of its vessel
+    StreamChangeEvent, // changed to another stream of its vessel
+    BirthEvent,        // added to the simulation (start, injection, mitosis)
+    DeathEvent         // removed from the simulation (killed, aged)
+};
+
+/**
+ * \brief ParticleEvent is one change of the state of a Particle as it is
+ * written to the event output. Position, vessel and stream are the ones after
+ * the event. The step and the time are stored once per step.
+ */
+struct ParticleEvent {
+    int32_t id;
+    uint8_t kind;       // ParticleEventKind
+    int32_t vesselID;
+    int32_t stream;
+    double x;
+    double y;
+    double z;
+    double arc;         // distance along the stream
+    int32_t type;       // ParticleType
+    double delay;       // velocity factor of the Particle
+    uint8_t isNl;       // is the nanobot a nanolocator?
+    int32_t target;     // target organ
+    uint8_t detected;   // active nanocollector carrying a message
+};
+}; // namespace utils
+#endif
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_PARTICLERECORD_
+#define CLASS_PARTICLERECORD_
+
+#include <cstdint>
+
+namespace utils {
+/**
+ * \brief ParticleRecord is the state of one Particle in one step as it is
+ * written to the output, one field per column of the csv file.
+ */
+struct ParticleRecord {
+    int32_t id;
+    double x;
+    double y;
+    double z;
+    double time;        // simulation time in seconds
+    int32_t vesselID;
+    int32_t stream;
+    uint8_t isNc;       // is the nanobot a nanocollector?
+    uint8_t isNl;       // is the nanobot a nanolocator?
+    int32_t target;     // target organ
+    uint8_t detected;   // active nanocollector carrying a message
+    int32_t type;       // ParticleType
+    int32_t npDetected; // times a nanoparticle got detected, -1 otherwise
+};
+}; // namespace utils
+#endif
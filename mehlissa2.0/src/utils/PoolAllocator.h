@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef H_POOLALLOCATOR_
+#define H_POOLALLOCATOR_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+namespace utils {
+/**
+ * \brief ObjectPool keeps the memory of freed objects of one kind for reuse.
+ *
+ * The memory is taken from chunks that grow up to MaxChunkNodes nodes and
+ * is never returned, so cells that die and are born at high rates reuse the
+ * same nodes instead of the general heap. All nodes of a pool have the size
+ * of its first allocation, other sizes are not pooled.
+ *
+ * Every thread keeps a cache of free nodes. It takes CacheBatch nodes at
+ * once from the shared free list and gives them back in batches when it
+ * holds too many, so births and deaths of the parallel steps rarely take the
+ * lock of the pool.
+ */
+template <typename Tag> class ObjectPool {
+private:
+    static constexpr size_t FirstChunkNodes = 64;
+    static constexpr size_t MaxChunkNodes = 4096;
+    static constexpr size_t CacheBatch = 64;
+
+    // Free nodes of one thread, given back to the pool when the thread ends.
+    struct ThreadCache {
+        vector<void *> nodes;
+
+        ~ThreadCache() {
+            Instance().Release(nodes, nodes.size());
+            // later deaths of this thread go to the shared free list
+            cacheDestroyed = true;
+        }
+    };
+
+    // set once the cache of the thread is destroyed, e.g. while Particles
+    // are freed during the static destruction
+    static inline thread_local bool cacheDestroyed = false;
+
+    mutex m_mutex; // guards the shared free list and the chunks
+    // set once by the first allocation and never changed afterwards, so
+    // Holds() reads them without the lock
+    atomic<size_t> m_nodeSize = 0;
+    size_t m_nodeAlign = 0;
+    size_t m_nextChunkNodes = FirstChunkNodes;
+    size_t m_reserved = 0; // nodes to reserve once the size is known
+    size_t m_capacity = 0; // nodes in all chunks
+    vector<void *> m_free;
+
+    ObjectPool() {}
+
+    static ThreadCache &Cache() {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Adds a chunk of nodes to the free list, the caller holds m_mutex.
+    void Grow(size_t nodes) {
+        size_t nodeSize = m_nodeSize.load(memory_order_relaxed);
+        char *chunk = (char *)::operator new(nodeSize * nodes,
+                                             align_val_t(m_nodeAlign));
+        // the first node of the chunk is handed out first
+        for (size_t i = nodes; i-- > 0;)
+            m_free.push_back(chunk + i * nodeSize);
+        m_capacity += nodes;
+    }
+
+    // Grows the free list to count nodes, the caller holds m_mutex.
+    void GrowTo(size_t count) {
+        if (m_free.size() < count)
+            Grow(count - m_free.size());
+    }
+
+    // Moves up to batch nodes of the shared free list to nodes, returns
+    // false if the pool holds nodes of another size.
+    bool Refill(vector<void *> &nodes, size_t size, size_t alignment,
+                size_t batch) {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_nodeSize.load(memory_order_relaxed) == 0) {
+            m_nodeAlign = max(alignment, alignof(void *));
+            m_nodeSize.store((size + m_nodeAlign - 1) / m_nodeAlign *
+                                 m_nodeAlign,
+                             memory_order_release);
+            GrowTo(m_reserved);
+        }
+        if (!Holds(size, alignment))
+            return false;
+        if (m_free.empty()) {
+            Grow(m_nextChunkNodes);
+            m_nextChunkNodes = min(2 * m_nextChunkNodes, MaxChunkNodes);
+        }
+        // the node at the back of the free list is still handed out first
+        size_t count = min(batch, m_free.size());
+        nodes.insert(nodes.end(), m_free.end() - count, m_free.end());
+        m_free.resize(m_free.size() - count);
+        return true;
+    }
+
+    // Moves the last count nodes of nodes to the shared free list.
+    void Release(vector<void *> &nodes, size_t count) {
+        lock_guard<mutex> lock(m_mutex);
+        m_free.insert(m_free.end(), nodes.end() - count, nodes.end());
+        nodes.resize(nodes.size() - count);
+    }
+
+public:
+    /// \returns the pool of Tag. It is never destroyed, Particles may still
+    /// be freed during the static destruction.
+    static ObjectPool &Instance() {
+        static ObjectPool *pool = new ObjectPool();
+        return *pool;
+    }
+
+    /// \returns a node for an object of size and alignment, nullptr if the
+    /// pool holds nodes of another size.
+    void *Allocate(size_t size, size_t alignment) {
+        vector<void *> single;
+        vector<void *> &nodes = cacheDestroyed ? single : Cache().nodes;
+        if (nodes.empty() &&
+            !Refill(nodes, size, alignment, cacheDestroyed ? 1 : CacheBatch))
+            return nullptr;
+        void *node = nodes.back();
+        nodes.pop_back();
+        return node;
+    }
+
+    /// Returns a node taken by Allocate() to the free list.
+    void Deallocate(void *node) {
+        if (cacheDestroyed) {
+            lock_guard<mutex> lock(m_mutex);
+            m_free.push_back(node);
+            return;
+        }
+        vector<void *> &nodes = Cache().nodes;
+        nodes.push_back(node);
+        // keeps a batch for the next births of the thread
+        if (nodes.size() >= 2 * CacheBatch)
+            Release(nodes, CacheBatch);
+    }
+
+    /// \returns true if objects of size and alignment are taken from the
+    /// pool.
+    bool Holds(size_t size, size_t alignment) {
+        size_t nodeSize = m_nodeSize.load(memory_order_acquire);
+        return size <= nodeSize && nodeSize - size < m_nodeAlign &&
+               alignment <= m_nodeAlign;
+    }
+
+    /// Makes count nodes free in one chunk, e.g. before an injection.
+    void Reserve(size_t count) {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_nodeSize.load(memory_order_relaxed) == 0)
+            m_reserved = max(m_reserved, count);
+        else
+            GrowTo(count);
+    }
+
+    /// \returns the number of nodes in all chunks.
+    size_t GetCapacity() {
+        lock_guard<mutex> lock(m_mutex);
+        return m_capacity;
+    }
+};
+
+/**
+ * \brief PoolAllocator takes single objects from the ObjectPool of Tag.
+ *
+ * Used with allocate_shared(), which rebinds the allocator to its node of
+ * control block and object. The rebound allocators keep Tag, so every
+ * Particle type has its own pool.
+ */
+template <typename T, typename Tag = T> class PoolAllocator {
+public:
+    using value_type = T;
+
+    template <typename U> struct rebind {
+        using other = PoolAllocator<U, Tag>;
+    };
+
+    PoolAllocator() {}
+
+    template <typename U> PoolAllocator(const PoolAllocator<U, Tag> &) {}
+
+    T *allocate(size_t n) {
+        if (n == 1) {
+            void *node = ObjectPool<Tag>::Instance().Allocate(sizeof(T),
+                                                              alignof(T));
+            if (node != nullptr)
+                return (T *)node;
+        }
+        return allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        ObjectPool<Tag> &pool = ObjectPool<Tag>::Instance();
+        if (n == 1 && pool.Holds(sizeof(T), alignof(T)))
+            pool.Deallocate(p);
+        else
+            allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const PoolAllocator<U, Tag> &) const {
+        return true;
+    }
+
+    template <typename U> bool operator!=(const PoolAllocator<U, Tag> &) const {
+        return false;
+    }
+};
+
+/// \returns a new T in a node of its ObjectPool.
+template <typename T> shared_ptr<T> MakePooled() {
+    return allocate_shared<T>(PoolAllocator<T>());
+}
+
+/// Makes count nodes of T free at once, before creating many of them.
+template <typename T> void ReservePooled(size_t count) {
+    ObjectPool<T>::Instance().Reserve(count);
+}
+}; // namespace utils
+#endif
@@ -18,57 +18,330 @@
  */
 
 #include "Printer.h"
+#include "Randomizer.h"
+#include <filesystem>
 
 using namespace std;
 namespace utils {
 
-Printer::Printer(int particleMode) {
-    particlePrintMode = particleMode;
-    output.open("csvNano.csv", ios::out | ios::trunc);
+OutputFormat Printer::outputFormat = CsvFormat;
+OutputPolicy Printer::outputPolicy;
+bool Printer::resumeOutput = false;
+OutputOffsets Printer::resumeOffsets;
+
+// Opens a file for writing. A resumed file is cut to offset and continued.
+static void OpenOutput(ofstream &file, string name, ios::openmode mode,
+                       bool resume, uint64_t offset) {
+    if (!resume) {
+        file.open(name, ios::out | ios::trunc | mode);
+        return;
+    }
+    filesystem::resize_file(name, offset);
+    file.open(name, ios::in | ios::out | mode);
+    file.seekp(offset);
 }
 
+void Printer::SetOutputFormat(string format) {
+    if (format == "csv")
+        outputFormat = CsvFormat;
+    else if (format == "binary")
+        outputFormat = BinaryFormat;
+    else if (format == "events")
+        outputFormat = EventFormat;
+    else if (format == "none")
+        outputFormat = NoOutputFormat;
+    else
+        throw runtime_error("Unknown output format: " + format);
+}
+
+// records per buffer before it is handed to the writer
+const size_t MaxBufferedRecords = 1 << 18;
+
+Printer::Printer(int particleMode) : Printer(particleMode, "csvNano.csv", "") {}
+
 Printer::Printer(int particleMode, string simFile, string gwFile) {
     particlePrintMode = particleMode;
-    output.open(simFile, ios::out | ios::trunc);
-    gwOutput.open(gwFile, ios::out | ios::trunc);
+    m_simFile = simFile;
+    m_gwFile = gwFile;
+    Open(resumeOutput ? &resumeOffsets : nullptr);
+}
+
+Printer::Printer(int particleMode, string simFile, string gwFile,
+                 OutputOffsets resumeAt) {
+    particlePrintMode = particleMode;
+    m_simFile = simFile;
+    m_gwFile = gwFile;
+    Open(&resumeAt);
 }
 
-Printer::~Printer() {
+void Printer::Open(const OutputOffsets *resume) {
+    m_format = outputFormat;
+    m_policy = outputPolicy;
+    // a resumed file already has its header
+    bool resuming = resume != nullptr;
+    OutputOffsets offsets = resuming ? *resume : OutputOffsets();
+    if (m_format == BinaryFormat) {
+        OpenOutput(output, m_simFile, ios::binary, resuming, offsets.simFile);
+        OpenOutput(indexOutput, m_simFile + ".idx", ios::binary, resuming,
+                   offsets.indexFile);
+        if (!resuming)
+            output.write("MEHLBIN1", 8);
+    } else if (m_format == EventFormat) {
+        OpenOutput(output, m_simFile, ios::binary, resuming, offsets.simFile);
+        // the movement is replayed with the same keyed random values
+        uint64_t seed = Randomizer::GetSeed();
+        if (!resuming) {
+            output.write("MEHLEVT2", 8);
+            output.write((const char *)&seed, sizeof(seed));
+        }
+    } else if (m_format == CsvFormat) {
+        OpenOutput(output, m_simFile, ios::openmode(), resuming,
+                   offsets.simFile);
+    }
+    if (m_gwFile != "")
+        OpenOutput(gwOutput, m_gwFile, ios::openmode(), resuming,
+                   offsets.gwFile);
+    m_filling.finishesStep = false;
+    m_writing.finishesStep = false;
+    m_filling.closesOutput = false;
+    m_writing.closesOutput = false;
+    m_writerBusy = false;
+    m_ordersVessels = false;
+    m_closed = false;
+    m_writer = thread(&Printer::WriteBuffers, this);
+}
+
+Printer::~Printer() { Close(); }
+
+void Printer::Close() {
+    {
+        unique_lock<mutex> lock(m_bufferMutex);
+        if (m_closed)
+            return;
+        m_filling.closesOutput = true;
+        HandOver(lock, true);
+        m_closed = true;
+    }
+    m_bufferHandedOver.notify_one();
+    m_writer.join();
     output.flush();
     output.close();
+    if (indexOutput.is_open())
+        indexOutput.close();
     if (gwOutput.is_open()) {
         gwOutput.flush();
         gwOutput.close();
     }
 }
 
+void Printer::HandOver(unique_lock<mutex> &lock, bool finishesStep) {
+    m_bufferWritten.wait(lock, [this] { return !m_writerBusy; });
+    m_filling.finishesStep = finishesStep;
+    m_filling.step = GlobalTimer::GetStep();
+    m_filling.time = GlobalTimer::NowInSeconds();
+    swap(m_filling, m_writing);
+    m_filling.particles.clear();
+    m_filling.gateways.clear();
+    m_filling.events.clear();
+    m_filling.closesOutput = false;
+    m_writerBusy = true;
+    m_bufferHandedOver.notify_one();
+}
+
+void Printer::AddRecords(vector<ParticleRecord> &records) {
+    unique_lock<mutex> lock(m_bufferMutex);
+    if (m_ordersVessels && records.size() > 0) {
+        // the records of one call belong to one vessel
+        vector<ParticleRecord> &kept =
+            m_vesselBuffers[records.front().vesselID].particles;
+        kept.insert(kept.end(), records.begin(), records.end());
+        return;
+    }
+    if (m_filling.particles.size() + records.size() > MaxBufferedRecords)
+        HandOver(lock, false);
+    m_filling.particles.insert(m_filling.particles.end(), records.begin(),
+                               records.end());
+}
+
+void Printer::AddEvents(vector<ParticleEvent> &events) {
+    unique_lock<mutex> lock(m_bufferMutex);
+    if (m_ordersVessels && events.size() > 0) {
+        vector<ParticleEvent> &kept =
+            m_vesselBuffers[events.front().vesselID].events;
+        kept.insert(kept.end(), events.begin(), events.end());
+        return;
+    }
+    if (m_filling.events.size() + events.size() > MaxBufferedRecords)
+        HandOver(lock, false);
+    m_filling.events.insert(m_filling.events.end(), events.begin(),
+                            events.end());
+}
+
+void Printer::WriteBuffers() {
+    unique_lock<mutex> lock(m_bufferMutex);
+    while (true) {
+        m_bufferHandedOver.wait(lock,
+                                [this] { return m_writerBusy || m_closed; });
+        if (!m_writerBusy)
+            return;
+        // m_writing belongs to the writer until m_writerBusy is reset
+        lock.unlock();
+        for (const ParticleRecord &r : m_writing.particles)
+            WriteParticle(r);
+        for (const GatewayRecord &g : m_writing.gateways)
+            gwOutput << g.vesselID << "," << g.time << ","
+                     << g.cancerCellNumber << "," << g.carTCellNumber << "\n";
+        if (m_writing.finishesStep && m_format == BinaryFormat &&
+            m_stepRecords.size() > 0)
+            WriteChunk(m_writing.step);
+        m_stepEvents.insert(m_stepEvents.end(), m_writing.events.begin(),
+                            m_writing.events.end());
+        // every simulated step gets a chunk, the one closing the file only
+        // if something was printed after the last step
+        if (m_writing.finishesStep && m_format == EventFormat &&
+            !(m_writing.closesOutput && m_stepEvents.empty()))
+            WriteEventChunk(m_writing.step, m_writing.time);
+        lock.lock();
+        m_writerBusy = false;
+        m_bufferWritten.notify_all();
+    }
+}
+
+void Printer::BeginVesselOrder() {
+    const std::lock_guard<std::mutex> lock(m_bufferMutex);
+    m_ordersVessels = true;
+}
+
+void Printer::EndVesselOrder() {
+    unique_lock<mutex> lock(m_bufferMutex);
+    m_ordersVessels = false;
+    for (auto &entry : m_vesselBuffers) {
+        OutputBuffer &kept = entry.second;
+        if (m_filling.particles.size() + kept.particles.size() >
+                MaxBufferedRecords ||
+            m_filling.events.size() + kept.events.size() > MaxBufferedRecords)
+            HandOver(lock, false);
+        m_filling.particles.insert(m_filling.particles.end(),
+                                   kept.particles.begin(),
+                                   kept.particles.end());
+        m_filling.events.insert(m_filling.events.end(), kept.events.begin(),
+                                kept.events.end());
+        m_filling.gateways.insert(m_filling.gateways.end(),
+                                  kept.gateways.begin(), kept.gateways.end());
+        // the buffers keep their capacity for the next steps
+        kept.particles.clear();
+        kept.events.clear();
+        kept.gateways.clear();
+    }
+}
+
+void Printer::FinishStep() {
+    unique_lock<mutex> lock(m_bufferMutex);
+    HandOver(lock, true);
+}
+
+OutputOffsets Printer::Flush() {
+    unique_lock<mutex> lock(m_bufferMutex);
+    m_bufferWritten.wait(lock, [this] { return !m_writerBusy; });
+    OutputOffsets offsets;
+    if (output.is_open()) {
+        output.flush();
+        offsets.simFile = output.tellp();
+    }
+    if (indexOutput.is_open()) {
+        indexOutput.flush();
+        offsets.indexFile = indexOutput.tellp();
+    }
+    if (gwOutput.is_open()) {
+        gwOutput.flush();
+        offsets.gwFile = gwOutput.tellp();
+    }
+    return offsets;
+}
+
+shared_ptr<Printer> Printer::Fork(string simFile, string gwFile,
+                                  OutputOffsets offsets) {
+    // a replay would draw the random values of the prefix for the branch
+    if (m_format == EventFormat)
+        throw runtime_error("Event output cannot be forked");
+    auto copy = [](string from, string to) {
+        filesystem::copy_file(from, to,
+                              filesystem::copy_options::overwrite_existing);
+    };
+    if (m_format == BinaryFormat) {
+        copy(m_simFile, simFile);
+        copy(m_simFile + ".idx", simFile + ".idx");
+    } else if (m_format == CsvFormat) {
+        copy(m_simFile, simFile);
+    }
+    if (m_gwFile != "" && gwFile != "")
+        copy(m_gwFile, gwFile);
+    else
+        gwFile = "";
+    return make_shared<Printer>(particlePrintMode, simFile, gwFile, offsets);
+}
+
 void Printer::PrintGateway(int vesselID, int cancerCellNumber,
                                  int carTCellNumber) {
     double m_start = GlobalTimer::NowInSeconds(); // TODO
-    gwOutput << vesselID << "," << m_start << "," << cancerCellNumber << ","
-             << carTCellNumber << "\n";
-}
-
-void Printer::PrintParticle(shared_ptr<Particle> n, int vesselID) {
-    int id = n->GetParticleID();
-    double x = n->GetPosition().x;
-    double y = n->GetPosition().y;
-    double z = n->GetPosition().z;
-    double m_start = GlobalTimer::NowInSeconds();
-    int BvID = vesselID;
-    int st = n->GetStream();
-    bool is_nc = n->GetDelay();             // is the nanobot a nanocollector?
-    bool is_nl = n->HasFingerprintLoaded(); // is the nanobot a nanolocator?
-    int target = n->GetTargetOrgan();
-    bool detected = n->HasTissueDetected(); // is the nanobot an active
-                                            // nanocollector carrying a message?
-    bool is_np = n->GetDelay() > 1;
-    int type = n->particleType;
-    int np_detected;
-    if (is_np)
-        np_detected = n->GotDetected();
-    else
-        np_detected = -1;
+    const std::lock_guard<std::mutex> lock(m_bufferMutex);
+    OutputBuffer &buffer =
+        m_ordersVessels ? m_vesselBuffers[vesselID] : m_filling;
+    buffer.gateways.push_back(
+        {vesselID, m_start, cancerCellNumber, carTCellNumber});
+}
+
+void Printer::PrintParticle(Particle &n, int vesselID) {
+    vector<ParticleRecord> records = {MakeRecord(n, vesselID)};
+    AddRecords(records);
+}
+
+ParticleRecord Printer::MakeRecord(Particle &n, int vesselID) {
+    ParticleRecord record;
+    Position position = n.GetPosition();
+    record.id = n.GetParticleID();
+    record.x = position.x;
+    record.y = position.y;
+    record.z = position.z;
+    record.time = GlobalTimer::NowInSeconds();
+    record.vesselID = vesselID;
+    record.stream = n.GetStream();
+    record.isNc = (bool)n.GetDelay();
+    record.isNl = n.HasFingerprintLoaded();
+    record.target = n.GetTargetOrgan();
+    record.detected = n.HasTissueDetected();
+    record.type = n.particleType;
+    bool is_np = n.GetDelay() > 1;
+    record.npDetected = is_np ? n.GotDetected() : -1;
+    return record;
+}
+
+ParticleEvent Printer::MakeEvent(Particle &n, ParticleEventKind kind,
+                                 int vesselID) {
+    ParticleEvent event;
+    Position position = n.GetPosition();
+    event.id = n.GetParticleID();
+    event.kind = kind;
+    event.vesselID = vesselID;
+    event.stream = n.GetStream();
+    event.x = position.x;
+    event.y = position.y;
+    event.z = position.z;
+    event.arc = n.GetArcLength();
+    event.type = n.particleType;
+    event.delay = n.GetDelay();
+    event.isNl = n.HasFingerprintLoaded();
+    event.target = n.GetTargetOrgan();
+    event.detected = n.HasTissueDetected();
+    return event;
+}
+
+void Printer::WriteParticle(const ParticleRecord &r) {
+    if (m_format == BinaryFormat) {
+        m_stepRecords.push_back(r);
+        return;
+    }
+    bool is_np = r.npDetected >= 0;
     // Output if Particles are simulated and we only want to know if they are
     // detected
     particlePrintMode = 0;
@@ -76,26 +349,120 @@ void Printer::PrintParticle(shared_ptr<Particle> n, int vesselID) {
         if (is_np) {
             // output << id << "," << m_start << "," << BvID << "," << is_np <<
             // "," << np_detected << "\n";
-            output << m_start << "," << np_detected << "\n";
+            output << r.time << "," << r.npDetected << "\n";
         }
     } else if (particlePrintMode == 2) {
         if (is_np) {
             // output << id << "," << m_start << "," << BvID << "," << is_np <<
             // "," << np_detected << "\n";
-            output << id << "," << m_start << "," << np_detected << "\n";
+            output << r.id << "," << r.time << "," << r.npDetected << "\n";
         }
     } else {
-        output << id << "," << x << "," << y << "," << z << "," << m_start
-               << "," << BvID << "," << st << "," << is_nc << "," << is_nl
-               << "," << target << "," << detected << "," << type << "\n";
+        output << r.id << "," << r.x << "," << r.y << "," << r.z << ","
+               << r.time << "," << r.vesselID << "," << r.stream << ","
+               << (bool)r.isNc << "," << (bool)r.isNl << "," << r.target
+               << "," << (bool)r.detected << "," << r.type << "\n";
     }
     // Without coordinates
     // output << id << "," << m_start << "," << BvID << "," << is_nc << "\n";
 }
 
-void Printer::PrintParticles(list<shared_ptr<Particle>> nbl, int vesselID) {
-    for (const shared_ptr<Particle> bot : nbl)
-        PrintParticle(bot, vesselID);
+void Printer::PrintParticles(span<Particle *const> nbl, int vesselID) {
+    // the state is copied here, the writer thread only sees the records
+    vector<ParticleRecord> records;
+    records.reserve(nbl.size());
+    for (Particle *bot : nbl)
+        records.push_back(MakeRecord(*bot, vesselID));
+    AddRecords(records);
+}
+
+void Printer::PrintRecords(vector<ParticleRecord> &records) {
+    AddRecords(records);
+}
+
+void Printer::PrintEvent(Particle &particle, ParticleEventKind kind,
+                         int vesselID) {
+    if (!m_policy.RecordsParticle(particle.GetParticleID(),
+                                  particle.particleType))
+        return;
+    vector<ParticleEvent> events = {MakeEvent(particle, kind, vesselID)};
+    AddEvents(events);
+}
+
+// writes one field of all records as a column
+template <typename R, typename T>
+static void WriteColumn(ofstream &output, const vector<R> &records,
+                        T R::*field) {
+    for (const R &r : records)
+        output.write((const char *)&(r.*field), sizeof(T));
+}
+
+void Printer::WriteChunk(uint64_t step) {
+    stable_sort(m_stepRecords.begin(), m_stepRecords.end(),
+                [](const ParticleRecord &a, const ParticleRecord &b) {
+                    return a.id < b.id;
+                });
+    // a chunk holds every Particle once, the index relies on the order
+    for (size_t i = 1; i < m_stepRecords.size(); i++) {
+        if (m_stepRecords[i].id <= m_stepRecords[i - 1].id) {
+            cout << "Chunk of step " << step << " holds the particle ID "
+                 << m_stepRecords[i].id << " twice" << endl;
+            break;
+        }
+    }
+    double time = m_stepRecords.front().time;
+    uint64_t count = m_stepRecords.size();
+    uint64_t offset = output.tellp();
+    output.write((const char *)&step, sizeof(step));
+    output.write((const char *)&time, sizeof(time));
+    output.write((const char *)&count, sizeof(count));
+    WriteColumn(output, m_stepRecords, &ParticleRecord::id);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::x);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::y);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::z);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::vesselID);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::stream);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::isNc);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::isNl);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::target);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::detected);
+    WriteColumn(output, m_stepRecords, &ParticleRecord::type);
+
+    int32_t firstID = m_stepRecords.front().id;
+    int32_t lastID = m_stepRecords.back().id;
+    indexOutput.write((const char *)&step, sizeof(step));
+    indexOutput.write((const char *)&time, sizeof(time));
+    indexOutput.write((const char *)&offset, sizeof(offset));
+    indexOutput.write((const char *)&count, sizeof(count));
+    indexOutput.write((const char *)&firstID, sizeof(firstID));
+    indexOutput.write((const char *)&lastID, sizeof(lastID));
+    m_stepRecords.clear();
+}
+
+void Printer::WriteEventChunk(uint64_t step, double time) {
+    // the events of one Particle keep their order
+    stable_sort(m_stepEvents.begin(), m_stepEvents.end(),
+                [](const ParticleEvent &a, const ParticleEvent &b) {
+                    return a.id < b.id;
+                });
+    uint64_t count = m_stepEvents.size();
+    output.write((const char *)&step, sizeof(step));
+    output.write((const char *)&time, sizeof(time));
+    output.write((const char *)&count, sizeof(count));
+    WriteColumn(output, m_stepEvents, &ParticleEvent::id);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::kind);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::vesselID);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::stream);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::x);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::y);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::z);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::arc);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::type);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::delay);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::isNl);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::target);
+    WriteColumn(output, m_stepEvents, &ParticleEvent::detected);
+    m_stepEvents.clear();
 }
 
 void Printer::PrintInTerminal(vector<shared_ptr<Bloodstream>> streamsOfVessel,
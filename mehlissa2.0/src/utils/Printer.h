@@ -21,35 +21,253 @@
 #define CLASS_PRINTNANOBOT_
 
 #include "../bloodcircuit/Bloodstream.h"
+#include "OutputPolicy.h"
+#include "ParticleEvent.h"
+#include "ParticleRecord.h"
 #include <iostream> 
 #include <fstream> 
 #include <vector> 
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <span>
+#include <map>
 
 using namespace std;
 using namespace bloodcircuit;
 
 namespace utils {
 
+/**
+ * Format of the particle output (simFile).
+ *
+ * CsvFormat writes one line with 12 columns per particle and print.
+ *
+ * BinaryFormat writes one chunk per step. A chunk has a header (uint64 step,
+ * double time, uint64 count) and then every column as an array of count
+ * values, sorted by particle ID: int32 id, double x, y, z, int32 vessel,
+ * int32 stream, uint8 is_nc, uint8 is_nl, int32 target, uint8 detected,
+ * int32 type. The file starts with the 8 bytes "MEHLBIN1". The sidecar
+ * simFile + ".idx" holds one entry per chunk: uint64 step, double time,
+ * uint64 file offset of the chunk, uint64 count, int32 smallest and largest
+ * particle ID. All values are little endian. The initial placement of the
+ * Particles has a chunk of its own before the chunks of the steps.
+ *
+ * EventFormat writes ParticleEvents instead of positions, one chunk per step
+ * with the same header as BinaryFormat followed by the columns int32 id,
+ * uint8 kind, int32 vessel, int32 stream, double x, y, z, double arc, int32
+ * type, double delay, uint8 is_nl, int32 target, uint8 detected, sorted by
+ * particle ID. The arc is the distance along the stream (see ParticleStore).
+ * The file starts with the 8 bytes "MEHLEVT2" and the uint64 seed of the
+ * simulation. Every step gets a chunk, also without events. The positions in
+ * between are rebuilt by MehlissaReconstruct. Flags that change inside a
+ * vessel (is_nl, detected) keep the value of the birth of the Particle.
+ *
+ * NoOutputFormat writes no simFile, e.g. if only statistics are needed.
+ */
+enum OutputFormat { CsvFormat, BinaryFormat, EventFormat, NoOutputFormat };
+
+// One line of the gateway output (gwFile).
+struct GatewayRecord {
+    int vesselID;
+    double time;
+    int cancerCellNumber;
+    int carTCellNumber;
+};
+
+// Sizes of the output files in bytes. A resumed simulation cuts its files to
+// the sizes of its checkpoint and continues there, so no step is missing or
+// written twice.
+struct OutputOffsets {
+    uint64_t simFile = 0;
+    uint64_t indexFile = 0; // sidecar of the binary format
+    uint64_t gwFile = 0;
+};
+
+// Records handed from the simulation to the writer thread at once.
+struct OutputBuffer {
+    vector<ParticleRecord> particles;
+    vector<GatewayRecord> gateways;
+    vector<ParticleEvent> events;
+    bool finishesStep; // last buffer of the step
+    bool closesOutput; // last buffer of the file
+    uint64_t step;
+    double time;
+};
+
+/**
+ * \brief Printer writes the particle and gateway output.
+ *
+ * The print functions only copy the state of the particles into records.
+ * Formatting and writing is done by a writer thread, so the output of a step
+ * overlaps with the simulation of the next one. The records are double
+ * buffered: the simulation fills one buffer while the writer writes the
+ * other. A full buffer is handed over when the writer is idle, otherwise the
+ * printing thread waits, which bounds the memory used for the output.
+ *
+ * Vessels that are stepped concurrently print between BeginVesselOrder() and
+ * EndVesselOrder(). Their output is kept per vessel and added in ascending
+ * vessel ID, the order of the sequential simulation, so the files do not
+ * depend on the number of threads.
+ */
 class Printer {
 private:
     ofstream output;
     ofstream gwOutput;
+    ofstream indexOutput;
     int particlePrintMode;
+    string m_simFile;
+    string m_gwFile;
+    OutputFormat m_format;
+    OutputPolicy m_policy;
+
+    // Owned by the simulation threads, guarded by m_bufferMutex
+    OutputBuffer m_filling;         // buffer currently filled
+    OutputBuffer m_writing;         // buffer handed to the writer
+    bool m_writerBusy;              // m_writing is not written yet
+    bool m_ordersVessels;           // output goes to m_vesselBuffers
+    map<int, OutputBuffer> m_vesselBuffers; // by vessel ID
+    bool m_closed;
+    // vessels print concurrently when simulated in parallel
+    mutex m_bufferMutex;
+    condition_variable m_bufferHandedOver; // writer waits for work
+    condition_variable m_bufferWritten;    // simulation waits for the writer
+    thread m_writer;
+
+    // Owned by the writer thread
+    vector<ParticleRecord> m_stepRecords; // binary: records of the step
+    vector<ParticleEvent> m_stepEvents;   // events of the step
+
+    ParticleRecord MakeRecord(Particle &n, int vesselID);
+
+    ParticleEvent MakeEvent(Particle &n, ParticleEventKind kind, int vesselID);
+
+    /// Hands m_filling to the writer, waits while the writer is busy. The
+    /// caller must hold lock.
+    void HandOver(unique_lock<mutex> &lock, bool finishesStep);
+
+    /// Adds the records to m_filling, hands it over when it is full.
+    void AddRecords(vector<ParticleRecord> &records);
+
+    /// Adds the events to m_filling, hands it over when it is full.
+    void AddEvents(vector<ParticleEvent> &events);
+
+    /// Main loop of the writer thread.
+    void WriteBuffers();
+
+    /// Writes one record in the output format.
+    void WriteParticle(const ParticleRecord &r);
+
+    /// Writes the records of the step as one binary chunk.
+    void WriteChunk(uint64_t step);
+
+    /// Writes the events of the step as one chunk.
+    void WriteEventChunk(uint64_t step, double time);
+
+    /// Opens the files and starts the writer, continues the files at resume
+    /// if it is not nullptr.
+    void Open(const OutputOffsets *resume);
 
 public:
+    // format of the Printers created from now on
+    static OutputFormat outputFormat;
+
+    /**
+     * \param format "csv", "binary", "events" or "none".
+     */
+    static void SetOutputFormat(string format);
+
+    // steps and Particles written by the Printers created from now on
+    static OutputPolicy outputPolicy;
+
+    // the Printers created from now on continue existing files at
+    // resumeOffsets instead of replacing them
+    static bool resumeOutput;
+    static OutputOffsets resumeOffsets;
+
     Printer(int particleMode);
     Printer(int particleMode, string simFile, string gwFile);
 
+    /// Continues simFile and gwFile at resumeAt.
+    Printer(int particleMode, string simFile, string gwFile,
+            OutputOffsets resumeAt);
+
     ~Printer();
 
+    /// \returns true if Particles are written in the given step.
+    bool RecordsStep(uint64_t step) {
+        return (m_format == CsvFormat || m_format == BinaryFormat) &&
+               m_policy.RecordsStep(step);
+    }
+
+    /// \returns true if events are written instead of the Particles.
+    bool RecordsEvents() { return m_format == EventFormat; }
+
+    /// \returns true if the Particle is written, callers check this before
+    /// collecting the Particles to print.
+    bool RecordsParticle(unsigned int id, ParticleType type) {
+        return m_policy.RecordsParticle(id, type);
+    }
+
     /// Prints one nanobot to a csv file.
-    void PrintParticle(shared_ptr<Particle> n, int vesselID);
+    void PrintParticle(Particle &n, int vesselID);
 
     /// Prints transposed/translated nanobots in the BloodVessel to a csv file.
-    void PrintParticles(list<shared_ptr<Particle>> nbl, int vesselID);
+    /// The Particles are only read, their owners keep them.
+    void PrintParticles(span<Particle *const> nbl, int vesselID);
+
+    /// Prints records that were not taken from a Particle, e.g. rebuilt from
+    /// events.
+    void PrintRecords(vector<ParticleRecord> &records);
+
+    /// Prints one event of the given kind for each of the Particles that
+    /// passes the output policy. Only used with EventFormat.
+    /// \param particles range of Particle pointers, owning or not.
+    template <typename Particles>
+    void PrintEvents(const Particles &particles, ParticleEventKind kind,
+                     int vesselID) {
+        vector<ParticleEvent> events;
+        for (const auto &bot : particles)
+            if (m_policy.RecordsParticle(bot->GetParticleID(),
+                                         bot->particleType))
+                events.push_back(MakeEvent(*bot, kind, vesselID));
+        if (events.size() > 0)
+            AddEvents(events);
+    }
+
+    /// Prints the event of one Particle, see PrintEvents().
+    void PrintEvent(Particle &particle, ParticleEventKind kind, int vesselID);
 
     void PrintGateway(int vesselID, int cancerCellNumber, int carTCellNumber);
 
+    /// Keeps the output per vessel until EndVesselOrder(), called before the
+    /// vessels print concurrently.
+    void BeginVesselOrder();
+
+    /// Adds the output kept since BeginVesselOrder() in ascending vessel ID.
+    void EndVesselOrder();
+
+    /// Called after every step, hands the records of the step to the writer.
+    void FinishStep();
+
+    /**
+     * Waits until the writer wrote the finished steps and flushes the files.
+     * Called between steps, after FinishStep().
+     * \returns the sizes of the files.
+     */
+    OutputOffsets Flush();
+
+    /**
+     * Copies the output written until offsets, see Flush(), to simFile and
+     * gwFile. \returns a Printer that continues the copies, e.g. for a
+     * branch of the simulation.
+     */
+    shared_ptr<Printer> Fork(string simFile, string gwFile,
+                             OutputOffsets offsets);
+
+    /// Writes all remaining records, stops the writer and closes the files.
+    void Close();
+
     // Debug Function, currently not used
     void PrintInTerminal(vector<shared_ptr<Bloodstream>> streamsOfVessel,
                          int vesselIDl);
@@ -21,22 +21,17 @@
 
 namespace utils {
 
-RandomStream::RandomStream(unsigned int seed, double min, double max) {
+RandomStream::RandomStream(KeyedRandom random, double min, double max)
+    : m_random(random) {
     this->min = min;
     this->max = max;
-    this->m_seed = seed;
-    mt19937 rnd_stream(m_seed);    
-    uniform_real_distribution uni_stream(0.0, 1.0);
 }
 
 RandomStream::~RandomStream() {
 }
     
 double RandomStream::GetValue() {
-    double value = uni_stream(rnd_stream);
-    value *= max;
-    value += min;
-    return value;
+    return m_random.GetValue(min, max);
 }
 } // namespace utils
 
@@ -20,6 +20,7 @@
 #ifndef H_RANDOMSTREAM_
 #define H_RANDOMSTREAM_
 
+#include "KeyedRandom.h"
 #include <iostream>
 #include <cstdint>
 #include <random>
@@ -31,12 +32,10 @@ class RandomStream {
 private:
     double min;
     double max;
-    unsigned int m_seed;
-    mt19937 rnd_stream;
-    uniform_real_distribution<> uni_stream;
+    KeyedRandom m_random;
 
 public:
-    RandomStream(unsigned int seed, double min, double max);
+    RandomStream(KeyedRandom random, double min, double max);
     ~RandomStream();
     
     double GetValue();
@@ -21,9 +21,6 @@
 
 namespace utils {
 static unsigned int m_seed;
-static mt19937 rnd_stream;
-static uniform_real_distribution stream_bool;
-static uniform_real_distribution stream_0_1;
 
 void Randomizer::InitRandomizer(bool isDeterministic) {
     std::random_device rnd = std::random_device();
@@ -31,38 +28,20 @@ void Randomizer::InitRandomizer(bool isDeterministic) {
         m_seed = 1;
     else
         m_seed = rnd();
-    mt19937 rnd_stream(m_seed);    
-    uniform_real_distribution stream_bool(0.0, 1.0);
-    uniform_real_distribution stream_0_1(0.0, 1.0);
 }
 
-bool Randomizer::GetRandomBoolean() {
-    double value = stream_bool(rnd_stream);
-    return value >= 0.5;
-}
-
-double Randomizer::GetRandomValue() {
-    double value = stream_0_1(rnd_stream);
-    return value;
-}
-
-double Randomizer::GetRandomValue(double min, double max) {
-    double value = stream_0_1(rnd_stream);
-    value *= max;
-    value += min;
-    return value;
-}
+unsigned int Randomizer::GetSeed() { return m_seed; }
 
-int Randomizer::GetRandomIntegerValue(int min, int max) {
-    double value = stream_0_1(rnd_stream);
-    if (value == 1) value = value - 0.01;
-    value *= max + 1;
-    value += min;
-    return std::floor(value);
+void Randomizer::SetSeed(unsigned int seed) {
+    m_seed = seed;
 }
 
-shared_ptr<RandomStream> Randomizer::GetNewRandomStream(double min, double max) {
-    shared_ptr<RandomStream> rs = make_shared<RandomStream>(m_seed, min, max);
+shared_ptr<RandomStream> Randomizer::GetNewRandomStream(double min, double max,
+                                                        int vessel,
+                                                        uint32_t subKey) {
+    KeyedRandom random(GlobalTimer::GetStep(), vessel, 0,
+                       KeyedRandom::InjectionPurpose, subKey);
+    shared_ptr<RandomStream> rs = make_shared<RandomStream>(random, min, max);
     return rs;
 }
 } // namespace utils
@@ -20,6 +20,8 @@
 #ifndef H_RANDOMIZER_
 #define H_RANDOMIZER_
 
+#include "GlobalTimer.h"
+#include "KeyedRandom.h"
 #include "RandomStream.h"
 #include <iostream>
 #include <cstdint>
@@ -34,17 +36,17 @@ private:
 public:
     static void InitRandomizer(bool isDeterministic);
 
-    // Will return either true or false randomly
-    static bool GetRandomBoolean();
+    // Will return the global seed, the key of all KeyedRandom draws.
+    static unsigned int GetSeed();
 
-    // Will return a random value between 0 and 1.
-    static double GetRandomValue();
+    // Sets the global seed, e.g. to the one of a recorded simulation.
+    static void SetSeed(unsigned int seed);
 
-    static double GetRandomValue(double min, double max);
-    
-    static int GetRandomIntegerValue(int min, int max);
-
-    static shared_ptr<RandomStream> GetNewRandomStream(double min, double max);
+    // Will return a stream of values in [min,max) that only depends on the
+    // seed, the current step, the vessel and the sub key.
+    static shared_ptr<RandomStream> GetNewRandomStream(double min, double max,
+                                                       int vessel,
+                                                       uint32_t subKey);
 };
 }; // namespace utils
 #endif
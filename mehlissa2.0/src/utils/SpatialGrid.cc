@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "SpatialGrid.h"
+
+namespace utils {
+
+SpatialGrid::SpatialGrid(double cellSize, bool planar) {
+    SetCellSize(cellSize);
+    m_planar = planar;
+}
+
+SpatialGrid::~SpatialGrid() {}
+
+void SpatialGrid::SetCellSize(double cellSize) {
+    // a cell size of 0 would put every point into its own cell
+    if (cellSize <= 0)
+        cellSize = 1;
+    m_cellSize = cellSize;
+}
+
+double SpatialGrid::GetCellSize() { return m_cellSize; }
+
+void SpatialGrid::Clear() {
+    m_points.clear();
+    m_keys.clear();
+    m_order.clear();
+    m_sortedX.clear();
+    m_sortedY.clear();
+    m_sortedZ.clear();
+    m_cells.clear();
+}
+
+size_t SpatialGrid::Insert(Position position) {
+    m_points.push_back(position);
+    return m_points.size() - 1;
+}
+
+int64_t SpatialGrid::CellCoordinate(double value) {
+    return (int64_t)floor(value / m_cellSize);
+}
+
+uint64_t SpatialGrid::CellKey(int64_t cx, int64_t cy, int64_t cz) {
+    // 21 bits per axis, the coordinates wrap around which only merges
+    // distant cells and never loses a neighbour
+    const uint64_t mask = (1ULL << 21) - 1;
+    return ((uint64_t)cx & mask) | (((uint64_t)cy & mask) << 21) |
+           (((uint64_t)cz & mask) << 42);
+}
+
+void SpatialGrid::Build() {
+    m_keys.resize(m_points.size());
+    m_order.resize(m_points.size());
+    for (size_t i = 0; i < m_points.size(); i++) {
+        int64_t cz = m_planar ? 0 : CellCoordinate(m_points[i].z);
+        m_keys[i] = CellKey(CellCoordinate(m_points[i].x),
+                            CellCoordinate(m_points[i].y), cz);
+        m_order[i] = i;
+    }
+    // stable keeps the insertion order inside a cell
+    stable_sort(m_order.begin(), m_order.end(),
+                [this](size_t a, size_t b) { return m_keys[a] < m_keys[b]; });
+    m_sortedX.resize(m_order.size());
+    m_sortedY.resize(m_order.size());
+    m_sortedZ.resize(m_order.size());
+    for (size_t o = 0; o < m_order.size(); o++) {
+        m_sortedX[o] = m_points[m_order[o]].x;
+        m_sortedY[o] = m_points[m_order[o]].y;
+        m_sortedZ[o] = m_planar ? 0 : m_points[m_order[o]].z;
+    }
+    m_cells.clear();
+    size_t start = 0;
+    while (start < m_order.size()) {
+        size_t end = start + 1;
+        uint64_t key = m_keys[m_order[start]];
+        while (end < m_order.size() && m_keys[m_order[end]] == key)
+            end++;
+        m_cells[key] = make_pair(start, end);
+        start = end;
+    }
+}
+
+size_t SpatialGrid::Size() { return m_points.size(); }
+
+double SpatialGrid::SquaredDistance(Position a, Position b) {
+    double dx = a.x - b.x;
+    double dy = a.y - b.y;
+    double dz = m_planar ? 0 : a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+void SpatialGrid::CellDistances(Position center, size_t first, size_t last,
+                                double *distSquared) {
+    const double *xs = m_sortedX.data();
+    const double *ys = m_sortedY.data();
+    const double *zs = m_sortedZ.data();
+    double cz = m_planar ? 0 : center.z;
+#pragma omp simd
+    for (size_t o = first; o < last; o++) {
+        double dx = xs[o] - center.x;
+        double dy = ys[o] - center.y;
+        double dz = zs[o] - cz;
+        distSquared[o - first] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+void SpatialGrid::Query(Position center, double radius,
+                        vector<size_t> &result) {
+    if (m_cells.empty())
+        return;
+    double radiusSquared = radius * radius;
+    int64_t minX = CellCoordinate(center.x - radius);
+    int64_t maxX = CellCoordinate(center.x + radius);
+    int64_t minY = CellCoordinate(center.y - radius);
+    int64_t maxY = CellCoordinate(center.y + radius);
+    int64_t minZ = m_planar ? 0 : CellCoordinate(center.z - radius);
+    int64_t maxZ = m_planar ? 0 : CellCoordinate(center.z + radius);
+    for (int64_t cz = minZ; cz <= maxZ; cz++) {
+        for (int64_t cy = minY; cy <= maxY; cy++) {
+            for (int64_t cx = minX; cx <= maxX; cx++) {
+                auto cell = m_cells.find(CellKey(cx, cy, cz));
+                if (cell == m_cells.end())
+                    continue;
+                size_t first = cell->second.first;
+                size_t last = cell->second.second;
+                m_distSquared.resize(last - first);
+                CellDistances(center, first, last, m_distSquared.data());
+                for (size_t o = first; o < last; o++) {
+                    if (m_distSquared[o - first] <= radiusSquared)
+                        result.push_back(m_order[o]);
+                }
+            }
+        }
+    }
+}
+
+size_t SpatialGrid::CountWithin(Position center, double radius) {
+    if (m_cells.empty() || radius <= 0)
+        return 0;
+    double radiusSquared = radius * radius;
+    const double *xs = m_sortedX.data();
+    const double *ys = m_sortedY.data();
+    const double *zs = m_sortedZ.data();
+    double pz = m_planar ? 0 : center.z;
+    size_t count = 0;
+    int64_t minX = CellCoordinate(center.x - radius);
+    int64_t maxX = CellCoordinate(center.x + radius);
+    int64_t minY = CellCoordinate(center.y - radius);
+    int64_t maxY = CellCoordinate(center.y + radius);
+    int64_t minZ = m_planar ? 0 : CellCoordinate(center.z - radius);
+    int64_t maxZ = m_planar ? 0 : CellCoordinate(center.z + radius);
+    for (int64_t cz = minZ; cz <= maxZ; cz++) {
+        for (int64_t cy = minY; cy <= maxY; cy++) {
+            for (int64_t cx = minX; cx <= maxX; cx++) {
+                auto cell = m_cells.find(CellKey(cx, cy, cz));
+                if (cell == m_cells.end())
+                    continue;
+                size_t first = cell->second.first;
+                size_t last = cell->second.second;
+#pragma omp simd reduction(+ : count)
+                for (size_t o = first; o < last; o++) {
+                    double dx = xs[o] - center.x;
+                    double dy = ys[o] - center.y;
+                    double dz = zs[o] - pz;
+                    count += (dx * dx + dy * dy + dz * dz) < radiusSquared;
+                }
+            }
+        }
+    }
+    return count;
+}
+} // namespace utils
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_SPATIALGRID_
+#define CLASS_SPATIALGRID_
+
+#include "Position.h"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace utils {
+/**
+ * \brief SpatialGrid is a uniform grid for fixed radius neighbour queries.
+ *
+ * Points are inserted with Insert(), then Build() buckets them by cell. A
+ * query only visits the cells overlapping the query radius, so a lookup costs
+ * the number of points nearby instead of all points. The grid is meant to be
+ * cleared and rebuilt once per simulation step. A planar grid ignores z, like
+ * the distance used for the cell interactions in BloodVessel.
+ *
+ * Build() copies the coordinates into arrays ordered by cell, so the distance
+ * kernels run over contiguous memory and can be vectorized.
+ */
+class SpatialGrid {
+private:
+    double m_cellSize;
+    bool m_planar;
+    vector<Position> m_points;
+    vector<uint64_t> m_keys;        // cell key per point
+    vector<size_t> m_order;         // point ids sorted by cell key
+    vector<double> m_sortedX;       // coordinates in the order of m_order
+    vector<double> m_sortedY;
+    vector<double> m_sortedZ;
+    unordered_map<uint64_t, pair<size_t, size_t>> m_cells; // key -> range in m_order
+
+    int64_t CellCoordinate(double value);
+
+    uint64_t CellKey(int64_t cx, int64_t cy, int64_t cz);
+
+    // squared distances from center to the points [first, last) of m_order
+    void CellDistances(Position center, size_t first, size_t last,
+                       double *distSquared);
+
+    vector<double> m_distSquared;   // scratch for CellDistances
+
+public:
+    /**
+     * \param cellSize edge length of a cell, should be about the largest query
+     * radius.
+     * \param planar true if z is ignored.
+     */
+    SpatialGrid(double cellSize, bool planar);
+
+    ~SpatialGrid();
+
+    /**
+     * \param cellSize edge length of a cell. Takes effect with the next
+     * Build().
+     */
+    void SetCellSize(double cellSize);
+
+    double GetCellSize();
+
+    /// Removes all points.
+    void Clear();
+
+    /// \returns the id of the inserted point, ids count up from 0.
+    size_t Insert(Position position);
+
+    /// Buckets the inserted points, must be called before Query().
+    void Build();
+
+    size_t Size();
+
+    /// \returns the position of the point with the given id.
+    Position GetPoint(size_t id) { return m_points[id]; }
+
+    /**
+     * Appends the ids of all points within radius of center to result.
+     * \param center of the query.
+     * \param radius inclusive maximum distance.
+     * \param result receives the point ids.
+     */
+    void Query(Position center, double radius, vector<size_t> &result);
+
+    /**
+     * \returns the number of points closer than radius to center (exclusive).
+     */
+    size_t CountWithin(Position center, double radius);
+
+    /**
+     * \returns the squared distance between a and b, without z if the grid
+     * is planar.
+     */
+    double SquaredDistance(Position a, Position b);
+};
+}; // namespace utils
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef H_STATEIO_
+#define H_STATEIO_
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace utils {
+/**
+ * Writes and reads values of the simulation state in their memory
+ * representation, like the binary output. Used for checkpoints, which are
+ * only read by the same build on the same machine.
+ */
+template <typename T> void WriteState(ostream &out, const T &value) {
+    out.write((const char *)&value, sizeof(T));
+}
+
+template <typename T> void ReadState(istream &in, T &value) {
+    in.read((char *)&value, sizeof(T));
+    if (!in)
+        throw runtime_error("Checkpoint ends unexpectedly");
+}
+}; // namespace utils
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#include "StreamingStatistics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace utils {
+
+RunningMoments::RunningMoments() {
+    m_count = 0;
+    m_mean = 0;
+    m_m2 = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+void RunningMoments::Add(double value) {
+    m_count++;
+    if (m_count == 1) {
+        m_min = value;
+        m_max = value;
+    } else {
+        m_min = min(m_min, value);
+        m_max = max(m_max, value);
+    }
+    double delta = value - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (value - m_mean);
+}
+
+double RunningMoments::GetVariance() {
+    if (m_count < 2)
+        return 0;
+    return m_m2 / (m_count - 1);
+}
+
+Histogram::Histogram(double binWidth, size_t numberOfBins)
+    : m_binWidth(binWidth), m_bins(numberOfBins, 0), m_overflow(0) {}
+
+void Histogram::Add(double value) {
+    if (value < 0)
+        value = 0;
+    double bin = floor(value / m_binWidth);
+    if (bin >= m_bins.size())
+        m_overflow++;
+    else
+        m_bins[(size_t)bin]++;
+}
+
+P2Quantile::P2Quantile(double p) {
+    m_p = p;
+    m_count = 0;
+    for (int i = 0; i < 5; i++) {
+        m_heights[i] = 0;
+        m_positions[i] = i + 1;
+    }
+    m_desired[0] = 1;
+    m_desired[1] = 1 + 2 * p;
+    m_desired[2] = 1 + 4 * p;
+    m_desired[3] = 3 + 2 * p;
+    m_desired[4] = 5;
+    m_increments[0] = 0;
+    m_increments[1] = p / 2;
+    m_increments[2] = p;
+    m_increments[3] = (1 + p) / 2;
+    m_increments[4] = 1;
+}
+
+double P2Quantile::Parabolic(int i, double d) {
+    return m_heights[i] +
+           d / (m_positions[i + 1] - m_positions[i - 1]) *
+               ((m_positions[i] - m_positions[i - 1] + d) *
+                    (m_heights[i + 1] - m_heights[i]) /
+                    (m_positions[i + 1] - m_positions[i]) +
+                (m_positions[i + 1] - m_positions[i] - d) *
+                    (m_heights[i] - m_heights[i - 1]) /
+                    (m_positions[i] - m_positions[i - 1]));
+}
+
+double P2Quantile::Linear(int i, int d) {
+    return m_heights[i] + d * (m_heights[i + d] - m_heights[i]) /
+                              (m_positions[i + d] - m_positions[i]);
+}
+
+void P2Quantile::Add(double value) {
+    // the first five values initialise the markers
+    if (m_count < 5) {
+        m_heights[m_count++] = value;
+        if (m_count == 5)
+            sort(m_heights, m_heights + 5);
+        return;
+    }
+    m_count++;
+    // cell k of the markers that contains the value
+    int k;
+    if (value < m_heights[0]) {
+        m_heights[0] = value;
+        k = 0;
+    } else if (value >= m_heights[4]) {
+        m_heights[4] = value;
+        k = 3;
+    } else {
+        k = 0;
+        while (value >= m_heights[k + 1])
+            k++;
+    }
+    for (int i = k + 1; i < 5; i++)
+        m_positions[i]++;
+    for (int i = 0; i < 5; i++)
+        m_desired[i] += m_increments[i];
+    // move the middle markers towards their desired positions
+    for (int i = 1; i < 4; i++) {
+        double d = m_desired[i] - m_positions[i];
+        if ((d >= 1 && m_positions[i + 1] - m_positions[i] > 1) ||
+            (d <= -1 && m_positions[i - 1] - m_positions[i] < -1)) {
+            int sign = d > 0 ? 1 : -1;
+            double height = Parabolic(i, sign);
+            if (m_heights[i - 1] < height && height < m_heights[i + 1])
+                m_heights[i] = height;
+            else
+                m_heights[i] = Linear(i, sign);
+            m_positions[i] += sign;
+        }
+    }
+}
+
+double P2Quantile::Get() {
+    if (m_count == 0)
+        return 0;
+    if (m_count >= 5)
+        return m_heights[2];
+    double sorted[5];
+    copy(m_heights, m_heights + m_count, sorted);
+    sort(sorted, sorted + m_count);
+    return sorted[(size_t)round(m_p * (m_count - 1))];
+}
+} // namespace utils
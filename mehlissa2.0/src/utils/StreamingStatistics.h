@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2025 Universität zu Lübeck [WENDT] and Technische Universität Berlin [DEBUS]
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ * Author: Regine Wendt <regine.wendt@uni-luebeck.de>
+ * Author: Lisa Y. Debus <debus@ccs-labs.org>
+ */
+
+#ifndef CLASS_STREAMINGSTATISTICS_
+#define CLASS_STREAMINGSTATISTICS_
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+namespace utils {
+/**
+ * \brief RunningMoments accumulates count, mean, variance, minimum and
+ * maximum of a sequence of values in constant memory (Welford's algorithm).
+ */
+class RunningMoments {
+private:
+    uint64_t m_count;
+    double m_mean;
+    double m_m2;     // sum of squared differences from the mean
+    double m_min;
+    double m_max;
+
+public:
+    RunningMoments();
+
+    void Add(double value);
+
+    uint64_t GetCount() { return m_count; }
+
+    double GetMean() { return m_mean; }
+
+    /// \returns the sample variance, 0 for less than two values.
+    double GetVariance();
+
+    double GetMin() { return m_min; }
+
+    double GetMax() { return m_max; }
+};
+
+/**
+ * \brief Histogram counts values in bins of fixed width starting at 0. Values
+ * beyond the last bin are counted as overflow, negative ones in the first bin.
+ */
+class Histogram {
+private:
+    double m_binWidth;
+    vector<uint64_t> m_bins;
+    uint64_t m_overflow;
+
+public:
+    Histogram(double binWidth, size_t numberOfBins);
+
+    void Add(double value);
+
+    double GetBinWidth() { return m_binWidth; }
+
+    const vector<uint64_t> &GetBins() { return m_bins; }
+
+    uint64_t GetOverflow() { return m_overflow; }
+};
+
+/**
+ * \brief P2Quantile estimates one quantile of a sequence of values in
+ * constant memory with the P-square algorithm of Jain and Chlamtac. Five
+ * markers follow the minimum, the maximum, the quantile and the quantiles
+ * halfway to the minimum and maximum. Up to five values the quantile is
+ * exact.
+ */
+class P2Quantile {
+private:
+    double m_p;            // quantile in (0,1)
+    uint64_t m_count;
+    double m_heights[5];   // marker heights
+    double m_positions[5]; // actual marker positions
+    double m_desired[5];   // desired marker positions
+    double m_increments[5];
+
+    double Parabolic(int i, double d);
+
+    double Linear(int i, int d);
+
+public:
+    P2Quantile(double p);
+
+    void Add(double value);
+
+    /// \returns the estimate, 0 without values.
+    double Get();
+};
+}; // namespace utils
+#endif